@@ -0,0 +1,119 @@
+// baseline.hpp - stored throughput baselines for the performance regression gate
+//
+// The baseline is a small JSON document checked in next to the benchmark:
+//   { "entries": [ { "name": "decode/contiguous/stream/4096/10", "gbps": 0.341, "noise": 0.02 }, ... ] }
+// gbps is the best of several repetitions and noise the relative gap between best and median.
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace baseline
+{
+  struct entry
+  {
+    std::string name;
+    double gbps = 0;
+    double noise = 0; // Relative spread, e.g. 0.05 for +-5%
+  };
+
+  // Slowdowns below this fraction are never reported, however quiet the recording was
+  inline constexpr double min_tolerance = 0.25;
+
+  // A noisy recording widens the tolerance, but never so far that a 2x slowdown passes
+  inline constexpr double max_tolerance = 0.45;
+
+  // How many recorded noise spreads a result may fall below the baseline
+  inline constexpr double noise_factor = 3.0;
+
+  inline double tolerance(const entry &e)
+  {
+    return std::clamp(noise_factor * e.noise, min_tolerance, max_tolerance);
+  }
+
+  inline bool write(const std::string &path, const std::vector<entry> &entries)
+  {
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f)
+    {
+      return false;
+    }
+    std::fprintf(f, "{\n  \"entries\": [\n");
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+      std::fprintf(
+          f,
+          "    { \"name\": \"%s\", \"gbps\": %.4f, \"noise\": %.4f }%s\n",
+          entries[i].name.c_str(),
+          entries[i].gbps,
+          entries[i].noise,
+          i + 1 < entries.size() ? "," : ""
+      );
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+  }
+
+  // Reads the format written by write(); returns nullopt if the file is missing or malformed
+  inline std::optional<std::vector<entry>> read(const std::string &path)
+  {
+    std::ifstream in(path);
+    if (!in)
+    {
+      return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    auto number_after = [&](std::size_t from, const char *key, std::size_t limit) -> std::optional<double> {
+      std::size_t pos = text.find(key, from);
+      if (pos == std::string::npos || limit <= pos)
+      {
+        return std::nullopt;
+      }
+      pos = text.find(':', pos);
+      if (pos == std::string::npos)
+      {
+        return std::nullopt;
+      }
+      const char *start = text.c_str() + pos + 1;
+      char *end = nullptr;
+      double value = std::strtod(start, &end);
+      if (end == start)
+      {
+        return std::nullopt;
+      }
+      return value;
+    };
+
+    std::vector<entry> entries;
+    std::size_t pos = 0;
+    while ((pos = text.find("\"name\"", pos)) != std::string::npos)
+    {
+      std::size_t open = text.find('"', text.find(':', pos));
+      std::size_t close = open == std::string::npos ? open : text.find('"', open + 1);
+      std::size_t limit = text.find('}', pos);
+      if (close == std::string::npos || limit == std::string::npos)
+      {
+        return std::nullopt;
+      }
+
+      auto gbps = number_after(close, "\"gbps\"", limit);
+      auto noise = number_after(close, "\"noise\"", limit);
+      if (!gbps)
+      {
+        return std::nullopt;
+      }
+      entries.push_back({ text.substr(open + 1, close - open - 1), *gbps, noise.value_or(0.0) });
+      pos = limit;
+    }
+    return entries;
+  }
+} // namespace baseline
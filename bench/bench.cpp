@@ -0,0 +1,705 @@
+// bench.cpp - encode/decode throughput benchmarks
+//
+// Axes: frame size (1 B - 16 MiB), zero density, input range category
+// (input-only, forward, contiguous) and single frames vs multi-frame streams.
+// decode-bl and decode-uc repeat the decode rows with branch_light_loop and unchecked_loop;
+// batch runs decode_batch() over contiguous streams.
+// --perf adds hardware counters (cycles, instructions, branch and cache misses) per input byte.
+// --record / --gate store and check a fixed workload matrix against a JSON baseline.
+#include "../src/mameCOBS.hpp"
+#include "baseline.hpp"
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <pthread.h>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace mamecobs;
+
+namespace
+{
+  // Reference cycles (TSC) where available, 0 otherwise
+  std::uint64_t cycles_now()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  // Byte view restricted to the given iterator category, so the non-contiguous paths get measured
+  template <class Category>
+  class restricted_view : public std::ranges::view_interface<restricted_view<Category>>
+  {
+    const std::byte *first_ = nullptr;
+    const std::byte *last_ = nullptr;
+
+  public:
+    class iterator
+    {
+      const std::byte *p_ = nullptr;
+
+    public:
+      using value_type = std::byte;
+      using difference_type = std::ptrdiff_t;
+      using iterator_concept = Category;
+
+      iterator() = default;
+      explicit iterator(const std::byte *p)
+          : p_(p)
+      {
+      }
+
+      std::byte operator*() const
+      {
+        return *p_;
+      }
+
+      iterator &operator++()
+      {
+        ++p_;
+        return *this;
+      }
+
+      iterator operator++(int)
+        requires std::same_as<Category, std::forward_iterator_tag>
+      {
+        iterator tmp = *this;
+        ++p_;
+        return tmp;
+      }
+
+      void operator++(int)
+        requires std::same_as<Category, std::input_iterator_tag>
+      {
+        ++p_;
+      }
+
+      bool operator==(const iterator &other) const
+        requires std::same_as<Category, std::forward_iterator_tag>
+      {
+        return p_ == other.p_;
+      }
+
+      friend bool operator==(const iterator &it, const std::byte *end)
+      {
+        return it.p_ == end;
+      }
+    };
+
+    restricted_view() = default;
+    explicit restricted_view(std::span<const std::byte> s)
+        : first_(s.data())
+        , last_(s.data() + s.size())
+    {
+    }
+
+    iterator begin() const
+    {
+      return iterator{ first_ };
+    }
+
+    const std::byte *end() const
+    {
+      return last_;
+    }
+  };
+
+  using input_view = restricted_view<std::input_iterator_tag>;
+  using forward_view = restricted_view<std::forward_iterator_tag>;
+
+  enum class input_kind
+  {
+    input,
+    forward,
+    contiguous
+  };
+
+  const char *name_of(input_kind kind)
+  {
+    switch (kind)
+    {
+    case input_kind::input:
+      return "input";
+    case input_kind::forward:
+      return "forward";
+    case input_kind::contiguous:
+      return "contiguous";
+    }
+    return "?";
+  }
+
+  template <class F>
+  decltype(auto) with_view(input_kind kind, std::span<const std::byte> s, F &&f)
+  {
+    switch (kind)
+    {
+    case input_kind::input:
+      return f(input_view{ s });
+    case input_kind::forward:
+      return f(forward_view{ s });
+    default:
+      return f(s);
+    }
+  }
+
+  struct workload
+  {
+    std::string op;
+    input_kind kind;
+    bool stream; // Multi-frame stream instead of one call per frame
+    std::size_t frame_size;
+    double zero_ratio;
+  };
+
+  struct measurement
+  {
+    double gbps;
+    double bytes_per_cycle;
+    perf::sample counts; // Hardware counters of the best run, when --perf is active
+  };
+
+  volatile std::size_t sink;
+
+  // Counters of the benchmark thread; empty unless --perf was given and some event is available
+  std::optional<perf::counters> active_counters;
+
+  std::vector<std::byte> make_payload(std::size_t size, double zero_ratio, std::uint32_t seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<> coin(0.0, 1.0);
+    std::uniform_int_distribution<> value(1, 255);
+    std::vector<std::byte> payload(size);
+    for (auto &b : payload)
+    {
+      b = coin(gen) < zero_ratio ? std::byte{ 0 } : std::byte{ static_cast<unsigned char>(value(gen)) };
+    }
+    return payload;
+  }
+
+  // Runs fn until enough work has been timed and returns the best repetition
+  measurement measure(std::size_t bytes_per_run, const std::function<void()> &fn)
+  {
+    using clock = std::chrono::steady_clock;
+    double best_seconds = 1e30;
+    std::uint64_t best_cycles = 0;
+    perf::sample best_counts;
+    auto budget_end = clock::now() + std::chrono::milliseconds(200);
+    int runs = 0;
+
+    do
+    {
+      if (active_counters)
+      {
+        active_counters->start();
+      }
+      auto t0 = clock::now();
+      std::uint64_t c0 = cycles_now();
+      fn();
+      std::uint64_t c1 = cycles_now();
+      auto t1 = clock::now();
+      perf::sample counts;
+      if (active_counters)
+      {
+        counts = active_counters->stop();
+      }
+      double seconds = std::chrono::duration<double>(t1 - t0).count();
+      if (seconds < best_seconds)
+      {
+        best_seconds = seconds;
+        best_cycles = c1 - c0;
+        best_counts = counts;
+      }
+      ++runs;
+    } while (runs < 3 || clock::now() < budget_end);
+
+    double bytes = static_cast<double>(bytes_per_run);
+    return {
+      bytes / best_seconds / 1e9, best_cycles ? bytes / static_cast<double>(best_cycles) : 0.0, best_counts
+    };
+  }
+
+  template <std::size_t MaxFrameSize, class Loop>
+  measurement bench_decode(const workload &w, std::span<const std::byte> encoded, std::size_t payload_bytes)
+  {
+    return measure(payload_bytes, [&] {
+      std::size_t total = 0;
+      with_view(w.kind, encoded, [&](auto view) {
+        for (auto frame : view | decode<MaxFrameSize, no_checksum, null_observer, Loop>())
+        {
+          total += frame ? frame->size() : 1;
+        }
+        return 0;
+      });
+      sink = total;
+    });
+  }
+
+  template <class Loop>
+  measurement run_decode(const workload &w, const std::vector<std::byte> &encoded, std::size_t payload_bytes);
+
+  measurement run(const workload &w)
+  {
+    // Streams carry at least 1 MiB so the per-call and per-frame costs separate
+    std::size_t frames = std::max<std::size_t>(1, (std::size_t{ 1 } << 20) / w.frame_size);
+    std::vector<std::byte> payload = make_payload(w.frame_size * frames, w.zero_ratio, 32);
+    std::vector<std::span<const std::byte>> frame_spans;
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+      frame_spans.emplace_back(payload.data() + i * w.frame_size, w.frame_size);
+    }
+
+    if (w.op == "encode")
+    {
+      std::vector<std::byte> out(payload.size() + payload.size() / 254 + 2 * frames + 16);
+      return measure(payload.size(), [&] {
+        std::byte *dst = out.data();
+        if (w.stream)
+        {
+          with_view(w.kind, payload, [&](auto first) {
+            using View = decltype(first);
+            std::vector<View> views;
+            for (auto s : frame_spans)
+            {
+              views.emplace_back(s);
+            }
+            for (auto b : views | encode(true))
+            {
+              *dst++ = b;
+            }
+            return 0;
+          });
+        }
+        else
+        {
+          for (auto s : frame_spans)
+          {
+            with_view(w.kind, s, [&](auto view) {
+              for (auto b : view | encode(true))
+              {
+                *dst++ = b;
+              }
+              return 0;
+            });
+          }
+        }
+        sink = static_cast<std::size_t>(dst - out.data());
+      });
+    }
+
+    std::vector<std::byte> encoded;
+    for (auto b : frame_spans | encode(true))
+    {
+      encoded.push_back(b);
+    }
+
+    if (w.op == "batch")
+    {
+      std::vector<std::byte> out(encoded.size());
+      std::vector<batch_frame> results(1024);
+      return measure(payload.size(), [&] {
+        std::size_t total = 0;
+        std::size_t consumed = 0;
+        while (true)
+        {
+          auto input = std::span<const std::byte>(encoded).subspan(consumed);
+          batch_result r = decode_batch(input, std::span(out).subspan(consumed), results);
+          if (r.frames == 0)
+          {
+            break;
+          }
+          for (std::size_t i = 0; i < r.frames; ++i)
+          {
+            total += results[i].error ? 1 : results[i].length;
+          }
+          consumed += r.consumed;
+        }
+        sink = total;
+      });
+    }
+
+    // "decode-bl" and "decode-uc" run the branch-light and unchecked loops instead of the state machine
+    if (w.op == "decode-bl")
+    {
+      return run_decode<branch_light_loop>(w, encoded, payload.size());
+    }
+    if (w.op == "decode-uc")
+    {
+      return run_decode<unchecked_loop>(w, encoded, payload.size());
+    }
+    return run_decode<state_machine_loop>(w, encoded, payload.size());
+  }
+
+  template <class Loop>
+  measurement run_decode(const workload &w, const std::vector<std::byte> &encoded, std::size_t payload_bytes)
+  {
+
+    if (!w.stream)
+    {
+      // One decode call per frame: measure the frame setup cost
+      std::vector<std::span<const std::byte>> encoded_frames;
+      const std::byte *start = encoded.data();
+      for (const std::byte *p = encoded.data(); p != encoded.data() + encoded.size(); ++p)
+      {
+        if (*p == std::byte{ 0 })
+        {
+          encoded_frames.emplace_back(start, static_cast<std::size_t>(p + 1 - start));
+          start = p + 1;
+        }
+      }
+
+      auto per_frame = [&]<std::size_t N>() {
+        return measure(payload_bytes, [&] {
+          std::size_t total = 0;
+          for (auto s : encoded_frames)
+          {
+            with_view(w.kind, s, [&](auto view) {
+              for (auto frame : view | decode<N, no_checksum, null_observer, Loop>())
+              {
+                total += frame ? frame->size() : 1;
+              }
+              return 0;
+            });
+          }
+          sink = total;
+        });
+      };
+      if (w.frame_size <= 4096)
+      {
+        return per_frame.template operator()<4096>();
+      }
+      if (w.frame_size <= (std::size_t{ 1 } << 20))
+      {
+        return per_frame.template operator()<(std::size_t{ 1 } << 20)>();
+      }
+      return per_frame.template operator()<(std::size_t{ 16 } << 20)>();
+    }
+
+    if (w.frame_size <= 4096)
+    {
+      return bench_decode<4096, Loop>(w, encoded, payload_bytes);
+    }
+    if (w.frame_size <= (std::size_t{ 1 } << 20))
+    {
+      return bench_decode<(std::size_t{ 1 } << 20), Loop>(w, encoded, payload_bytes);
+    }
+    return bench_decode<(std::size_t{ 16 } << 20), Loop>(w, encoded, payload_bytes);
+  }
+
+  std::string size_label(std::size_t size)
+  {
+    if (size >= (std::size_t{ 1 } << 20))
+    {
+      return std::to_string(size >> 20) + " MiB";
+    }
+    if (size >= 1024)
+    {
+      return std::to_string(size >> 10) + " KiB";
+    }
+    return std::to_string(size) + " B";
+  }
+
+  // decode<16 MiB> keeps its frame buffer inside the iterator, which lives on the stack
+  void run_with_large_stack(const std::function<void()> &fn)
+  {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, std::size_t{ 64 } << 20);
+    pthread_t thread;
+    auto trampoline = [](void *arg) -> void * {
+      (*static_cast<const std::function<void()> *>(arg))();
+      return nullptr;
+    };
+    if (pthread_create(&thread, &attr, trampoline, const_cast<std::function<void()> *>(&fn)) != 0)
+    {
+      std::fprintf(stderr, "failed to create benchmark thread\n");
+      std::exit(1);
+    }
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+  }
+
+  // Fixed matrix checked by the regression gate; names are the keys of the baseline file
+  std::vector<workload> gate_workloads()
+  {
+    constexpr std::size_t mib = std::size_t{ 1 } << 20;
+    return {
+      { "encode", input_kind::contiguous, false, 4096, 0.0 },
+      { "encode", input_kind::contiguous, false, 4096, 0.1 },
+      { "encode", input_kind::contiguous, true, mib, 0.0 },
+      { "encode", input_kind::contiguous, true, mib, 0.1 },
+      { "encode", input_kind::input, true, 4096, 0.1 },
+      { "decode", input_kind::contiguous, false, 4096, 0.0 },
+      { "decode", input_kind::contiguous, false, 4096, 0.1 },
+      { "decode", input_kind::contiguous, true, mib, 0.0 },
+      { "decode", input_kind::contiguous, true, mib, 0.1 },
+      { "decode", input_kind::input, true, 4096, 0.1 },
+      { "decode", input_kind::forward, true, 4096, 0.1 },
+    };
+  }
+
+  std::string gate_name(const workload &w)
+  {
+    return w.op + "/" + name_of(w.kind) + "/" + (w.stream ? "stream" : "single") + "/" +
+           std::to_string(w.frame_size) + "/" + std::to_string(static_cast<int>(w.zero_ratio * 100 + 0.5));
+  }
+
+  // Best throughput of several repetitions; the gap between best and median estimates the noise
+  baseline::entry measure_entry(const workload &w)
+  {
+    constexpr int repetitions = 5;
+    run(w); // Warm-up: page in the buffers and let the clock settle
+    std::vector<double> samples;
+    for (int i = 0; i < repetitions; ++i)
+    {
+      samples.push_back(run(w).gbps);
+    }
+    std::sort(samples.begin(), samples.end());
+    double best = samples.back();
+    return { gate_name(w), best, (best - samples[samples.size() / 2]) / best };
+  }
+
+  int record_baseline(const std::string &path)
+  {
+    std::vector<baseline::entry> entries;
+    for (const workload &w : gate_workloads())
+    {
+      entries.push_back(measure_entry(w));
+      std::printf("%-40s %10.3f GB/s  noise %5.1f%%\n", entries.back().name.c_str(), entries.back().gbps,
+                  entries.back().noise * 100);
+      std::fflush(stdout);
+    }
+    if (!baseline::write(path, entries))
+    {
+      std::fprintf(stderr, "failed to write %s\n", path.c_str());
+      return 2;
+    }
+    return 0;
+  }
+
+  // Fails when a workload falls below its baseline by more than the noise-aware tolerance
+  int check_baseline(const std::string &path)
+  {
+    auto stored = baseline::read(path);
+    if (!stored)
+    {
+      std::fprintf(stderr, "cannot read baseline %s\n", path.c_str());
+      return 2;
+    }
+
+    int regressions = 0;
+    std::printf("%-40s %10s %10s %8s %8s\n", "workload", "baseline", "GB/s", "change", "limit");
+    for (const workload &w : gate_workloads())
+    {
+      baseline::entry current = measure_entry(w);
+      auto it = std::find_if(stored->begin(), stored->end(), [&](const baseline::entry &e) {
+        return e.name == current.name;
+      });
+      if (it == stored->end())
+      {
+        std::printf(
+            "%-40s %10s %10.3f %8s %8s  no baseline\n",
+            current.name.c_str(),
+            "-",
+            current.gbps,
+            "-",
+            "-"
+        );
+        continue;
+      }
+
+      double limit = baseline::tolerance(*it);
+      if (current.gbps / it->gbps - 1.0 < -limit)
+      {
+        // Confirm with a second round before blaming the code for a noisy neighbour
+        current.gbps = std::max(current.gbps, measure_entry(w).gbps);
+      }
+      double change = current.gbps / it->gbps - 1.0;
+      bool regressed = change < -limit;
+      regressions += regressed;
+      std::printf("%-40s %10.3f %10.3f %+7.1f%% %7.1f%%  %s\n", current.name.c_str(), it->gbps, current.gbps,
+                  change * 100, -limit * 100, regressed ? "REGRESSION" : "ok");
+      std::fflush(stdout);
+    }
+
+    if (regressions)
+    {
+      std::printf("%d workload(s) regressed against %s\n", regressions, path.c_str());
+      return 1;
+    }
+    return 0;
+  }
+
+  // Prints each counter normalised per input byte, "-" where the event is unavailable
+  void print_counts(const perf::sample &counts, std::size_t bytes)
+  {
+    for (const auto &count : counts)
+    {
+      if (count)
+      {
+        std::printf(" %12.4f", static_cast<double>(*count) / static_cast<double>(bytes));
+      }
+      else
+      {
+        std::printf(" %12s", "-");
+      }
+    }
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  bool quick = false;
+  bool use_perf = false;
+  std::string filter;
+  std::string record_path;
+  std::string gate_path;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string_view arg = argv[i];
+    if (arg == "--quick")
+    {
+      quick = true;
+    }
+    else if (arg == "--perf")
+    {
+      use_perf = true;
+    }
+    else if (arg == "--filter" && i + 1 < argc)
+    {
+      filter = argv[++i];
+    }
+    else if (arg == "--record" && i + 1 < argc)
+    {
+      record_path = argv[++i];
+    }
+    else if (arg == "--gate" && i + 1 < argc)
+    {
+      gate_path = argv[++i];
+    }
+    else
+    {
+      std::fprintf(
+          stderr,
+          "usage: %s [--quick] [--perf] [--filter substring] [--record baseline.json | --gate "
+          "baseline.json]\n",
+          argv[0]
+      );
+      return 2;
+    }
+  }
+
+  if (!record_path.empty() || !gate_path.empty())
+  {
+    int status = 0;
+    run_with_large_stack([&] {
+      status = record_path.empty() ? check_baseline(gate_path) : record_baseline(record_path);
+    });
+    return status;
+  }
+
+  std::vector<std::size_t> sizes = {
+    1, 16, 256, 4096, 65536, std::size_t{ 1 } << 20, std::size_t{ 16 } << 20
+  };
+  std::vector<double> densities = { 0.0, 0.01, 0.1, 0.5, 1.0 };
+  if (quick)
+  {
+    sizes = { 16, 4096, std::size_t{ 1 } << 20 };
+    densities = { 0.0, 0.1 };
+  }
+
+  std::printf(
+      "%-9s %-11s %-7s %9s %6s %10s %10s",
+      "op",
+      "input",
+      "frames",
+      "size",
+      "zeros",
+      "GB/s",
+      "B/cycle"
+  );
+  if (use_perf)
+  {
+    for (const char *name : perf::event_names)
+    {
+      std::printf(" %10s/B", name);
+    }
+  }
+  std::printf("\n");
+  run_with_large_stack([&] {
+    // perf events count the thread that opened them, so they live on the benchmark thread
+    if (use_perf)
+    {
+      active_counters.emplace();
+      if (!active_counters->any_available())
+      {
+        active_counters.reset();
+        std::fprintf(
+            stderr,
+            "perf events unavailable (check kernel.perf_event_paranoid); counters disabled\n"
+        );
+      }
+    }
+
+    for (const char *op : { "encode", "decode", "decode-bl", "decode-uc", "batch" })
+    {
+      for (input_kind kind : { input_kind::input, input_kind::forward, input_kind::contiguous })
+      {
+        for (bool stream : { false, true })
+        {
+          if (std::string_view(op) == "batch" && (kind != input_kind::contiguous || !stream))
+          {
+            continue;
+          }
+          for (std::size_t size : sizes)
+          {
+            for (double density : densities)
+            {
+              workload w{ op, kind, stream, size, density };
+              char label[128];
+              std::snprintf(
+                  label,
+                  sizeof(label),
+                  "%-9s %-11s %-7s %9s %5.0f%%",
+                  op,
+                  name_of(kind),
+                  stream ? "stream" : "single",
+                  size_label(size).c_str(),
+                  density * 100
+              );
+              if (!filter.empty() && std::string_view(label).find(filter) == std::string_view::npos)
+              {
+                continue;
+              }
+
+              measurement m = run(w);
+              std::printf("%s %10.3f %10.3f", label, m.gbps, m.bytes_per_cycle);
+              if (use_perf)
+              {
+                std::size_t frames = std::max<std::size_t>(1, (std::size_t{ 1 } << 20) / size);
+                print_counts(m.counts, size * frames);
+              }
+              std::printf("\n");
+              std::fflush(stdout);
+            }
+          }
+        }
+      }
+    }
+  });
+  return 0;
+}
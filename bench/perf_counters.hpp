@@ -0,0 +1,155 @@
+// perf_counters.hpp - Linux hardware performance counters for the benchmarks
+//
+// Each event is opened on its own (user space only, calling thread) so that a
+// counter the kernel, the container or the CPU refuses simply reads as
+// unavailable instead of taking the whole set down.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf
+{
+  enum class event
+  {
+    cycles,
+    instructions,
+    branch_misses,
+    l1d_misses,
+    llc_misses,
+  };
+
+  inline constexpr std::size_t event_count = 5;
+
+  inline constexpr std::array<const char *, event_count> event_names = {
+    "cycles", "instr", "br-miss", "L1d-miss", "LLC-miss"
+  };
+
+  // Counter values of one measured region; nullopt where the event is unavailable
+  using sample = std::array<std::optional<std::uint64_t>, event_count>;
+
+  class counters
+  {
+    std::array<int, event_count> fds_;
+
+#if defined(__linux__)
+    static int open_event(std::uint32_t type, std::uint64_t config)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    static constexpr std::uint64_t cache_event(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+    {
+      return cache | (op << 8) | (result << 16);
+    }
+#endif
+
+  public:
+    counters()
+    {
+      fds_.fill(-1);
+#if defined(__linux__)
+      fds_[static_cast<std::size_t>(event::cycles)] =
+          open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+      fds_[static_cast<std::size_t>(event::instructions)] =
+          open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+      fds_[static_cast<std::size_t>(event::branch_misses)] =
+          open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+      fds_[static_cast<std::size_t>(event::l1d_misses)] = open_event(
+          PERF_TYPE_HW_CACHE,
+          cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)
+      );
+      fds_[static_cast<std::size_t>(event::llc_misses)] =
+          open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+    }
+
+    ~counters()
+    {
+#if defined(__linux__)
+      for (int fd : fds_)
+      {
+        if (fd >= 0)
+        {
+          close(fd);
+        }
+      }
+#endif
+    }
+
+    counters(const counters &) = delete;
+    counters &operator=(const counters &) = delete;
+
+    bool available(event e) const
+    {
+      return fds_[static_cast<std::size_t>(e)] >= 0;
+    }
+
+    bool any_available() const
+    {
+      for (int fd : fds_)
+      {
+        if (fd >= 0)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+      for (int fd : fds_)
+      {
+        if (fd >= 0)
+        {
+          ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+          ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+      }
+#endif
+    }
+
+    sample stop()
+    {
+      sample s;
+#if defined(__linux__)
+      for (int fd : fds_)
+      {
+        if (fd >= 0)
+        {
+          ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+      }
+      for (std::size_t i = 0; i < event_count; ++i)
+      {
+        std::uint64_t value;
+        if (fds_[i] >= 0 && read(fds_[i], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value)))
+        {
+          s[i] = value;
+        }
+      }
+#endif
+      return s;
+    }
+  };
+} // namespace perf
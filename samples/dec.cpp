@@ -35,7 +35,7 @@ int main()
     }
     else
     {
-      std::cout << "Decode error: " << static_cast<int>(frame_result.error()) << "\n";
+      std::cout << "Decode error: " << static_cast<int>(frame_result.error().kind) << "\n";
     }
   }
 
@@ -94,7 +94,7 @@ int main()
     }
     else
     {
-      std::cout << "Decode error during roundtrip: " << static_cast<int>(frame_result.error()) << "\n";
+      std::cout << "Decode error during roundtrip: " << static_cast<int>(frame_result.error().kind) << "\n";
       return 1;
     }
   }
@@ -155,7 +155,7 @@ int main()
     }
     else
     {
-      std::cout << "ERROR: " << static_cast<int>(frame_result.error());
+      std::cout << "ERROR: " << static_cast<int>(frame_result.error().kind);
     }
     std::cout << "\n";
   }
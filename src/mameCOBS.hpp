@@ -1,96 +1,3658 @@
 // mameCOBS_v2.hpp - Chunk-of-chunks COBS implementation
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <expected>
+#include <memory>
 #include <optional>
 #include <ranges>
 #include <span>
 
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+// AVX2 / AVX-512 kernels are built with function target attributes and picked at runtime
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(MAMECOBS_NO_DISPATCH)
+#define MAMECOBS_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
 namespace mamecobs
 {
   // Error types for decode operations
   enum class decode_error
   {
-    oversized,    // Frame exceeds MaxFrameSize
-    invalid_cobs, // Invalid COBS data structure
-    incomplete    // Incomplete frame at end of stream
+    oversized,         // Frame exceeds MaxFrameSize
+    invalid_cobs,      // Invalid COBS data structure
+    incomplete,        // Incomplete frame at end of stream
+    checksum_mismatch, // Trailing checksum does not match the frame payload
+    size_mismatch,     // Frame length differs from sizeof(T) in decode_as<T>()
+    count              // Number of error kinds, not an error itself
+  };
+
+  // Error value of the decoders: where a frame failed and how much input it cost. Converts to and
+  // compares equal with its decode_error kind; print it or switch on it through kind.
+  struct frame_error
+  {
+    decode_error kind;
+    std::uint64_t offset = 0;      // Stream offset of the input byte at which the error was detected
+    std::uint64_t frame_index = 0; // Index of the failed frame among all frames of the stream
+    // Input bytes of the frame consumed when the error was reported; bytes skipped after it to reach
+    // the next delimiter are counted by the decoder's resync_bytes() and Observer::on_resync()
+    std::uint64_t discarded = 0;
+
+    constexpr operator decode_error() const noexcept
+    {
+      return kind;
+    }
+
+    friend constexpr bool operator==(const frame_error &e, decode_error kind) noexcept
+    {
+      return e.kind == kind;
+    }
+  };
+
+  // Outcome of step_decoder::step()
+  enum class step_status
+  {
+    pending, // Budget used up before the next frame or error; call step() again
+    frame,   // frame() holds a decoded frame
+    error,   // error() describes a failed frame; the next step() skips the rest of it
+    finished // Input exhausted
+  };
+
+  // Outcome of byte_decoder::push_byte()
+  enum class push_status : std::uint8_t
+  {
+    need_more,      // Byte absorbed; the frame is still open
+    frame_complete, // frame() holds the frame ended by this delimiter
+    error           // error() tells why; the rest of the frame up to the next delimiter is dropped
+  };
+
+  // One frame reported by decode_batch(). A frame decodes to the output position of its own encoding:
+  // its bytes are output[offset, offset + length). The only error is a block cut by the delimiter that
+  // ends the frame, so nothing is skipped after it: an error's length is the frame_error::discarded
+  // decode() reports for the same frame.
+  struct batch_frame
+  {
+    std::uint32_t offset = 0; // Input offset of the frame, which is also where its decoded bytes start
+    std::uint32_t length = 0; // Decoded size; on error, the input bytes of the frame through its delimiter
+    std::optional<decode_error> error;
+  };
+
+  // Outcome of decode_batch()
+  struct batch_result
+  {
+    std::size_t frames = 0;   // Entries written to the frames array
+    std::size_t consumed = 0; // Input bytes through the delimiter of the last frame reported
   };
+
   template <class T>
   concept ByteLike = std::same_as<std::remove_cvref_t<T>, std::byte> ||
                      (std::integral<std::remove_cvref_t<T>> && sizeof(std::remove_cvref_t<T>) == 1);
 
-  template <class T>
-  concept ByteRange = std::ranges::input_range<T> && ByteLike<std::ranges::range_value_t<T>>;
+  template <class T>
+  concept ByteRange = std::ranges::input_range<T> && ByteLike<std::ranges::range_value_t<T>>;
+
+  template <class T>
+  concept ByteRangeRange = std::ranges::input_range<T> && ByteRange<std::ranges::range_value_t<T>>;
+
+  // Frames given as gather lists: each frame is a range of byte segments encoded as one payload
+  template <class T>
+  concept SegmentedFrameRange = std::ranges::input_range<T> && ByteRangeRange<std::ranges::range_value_t<T>>;
+
+  inline constexpr std::byte frame_delim{ 0x00 };
+
+  // Receiver of decode_segmented(): begin_frame() opens a frame, data() hands over its decoded bytes in
+  // order, one segment at a time, and end_frame() closes it with its size or the error that ended it
+  template <class S>
+  concept FrameSink = requires(S &sink,
+                               std::span<const std::byte> segment,
+                               const std::expected<std::uint64_t, frame_error> &result) {
+    sink.begin_frame();
+    sink.data(segment);
+    sink.end_frame(result);
+  };
+
+  // Scalar loop policies of decode<MaxFrameSize, Checksum, Observer, Loop>(). state_machine_loop walks
+  // wait_for_code / read_data_bytes / handle_zero per block and uses the vector kernels on contiguous
+  // input. branch_light_loop folds the block counter and the code byte into conditional moves, a
+  // better fit for targets without SIMD, where the state switches mispredict on random payloads.
+  // unchecked_loop is for trusted input only: it copies whole blocks as their code bytes announce
+  // them, without looking for misplaced delimiters or zero codes, and its result on malformed input
+  // is undefined (see process_frame_unchecked() for what it does guarantee).
+  // COBS/R always uses the state machine. bench/bench.cpp measures them (decode, decode-bl, decode-uc).
+  struct state_machine_loop
+  {
+  };
+
+  struct branch_light_loop
+  {
+  };
+
+  struct unchecked_loop
+  {
+  };
+
+  // Instruction sets of the contiguous-input kernels, in increasing order of preference
+  enum class simd_level
+  {
+    scalar,
+    swar, // 64-bit word at a time, portable
+    sse2,
+    avx2,
+    avx512 // AVX-512F + BW
+  };
+
+  // Observer policies: encode<Checksum, Observer>() and decode<MaxFrameSize, Checksum, Observer>()
+  // report state-machine events to a default-constructed Observer. Hooks of null_observer are
+  // empty and the byte accounting feeding them is compiled out.
+  struct null_observer
+  {
+    constexpr void on_frame_encoded(std::size_t /*payload_size*/, std::size_t /*encoded_size*/) noexcept
+    {
+    }
+
+    constexpr void on_frame_decoded(std::size_t /*encoded_size*/, std::size_t /*frame_size*/) noexcept
+    {
+    }
+
+    constexpr void on_decode_error(decode_error, std::size_t /*encoded_size*/) noexcept
+    {
+    }
+
+    // Input bytes skipped after an error, up to and including the delimiter the decoder resynced on
+    constexpr void on_resync(std::size_t /*skipped*/) noexcept
+    {
+    }
+  };
+
+  // Per-thread codec counters; cache-line aligned so counters of different threads never share a line
+  struct alignas(64) codec_stats
+  {
+    std::uint64_t frames_encoded = 0;
+    std::uint64_t encode_bytes_in = 0;
+    std::uint64_t encode_bytes_out = 0;
+    std::uint64_t frames_decoded = 0;
+    std::uint64_t decode_bytes_in = 0;
+    std::uint64_t decode_bytes_out = 0;
+    // Indexed by decode_error
+    std::array<std::uint64_t, static_cast<std::size_t>(decode_error::count)> decode_errors{};
+    std::uint64_t resync_bytes = 0;   // Input skipped while resynchronising, including each resync delimiter
+    std::uint64_t max_frame_size = 0; // Largest payload encoded or decoded
+
+    codec_stats &operator+=(const codec_stats &other) noexcept
+    {
+      frames_encoded += other.frames_encoded;
+      encode_bytes_in += other.encode_bytes_in;
+      encode_bytes_out += other.encode_bytes_out;
+      frames_decoded += other.frames_decoded;
+      decode_bytes_in += other.decode_bytes_in;
+      decode_bytes_out += other.decode_bytes_out;
+      for (std::size_t i = 0; i < decode_errors.size(); ++i)
+      {
+        decode_errors[i] += other.decode_errors[i];
+      }
+      resync_bytes += other.resync_bytes;
+      max_frame_size = std::max(max_frame_size, other.max_frame_size);
+      return *this;
+    }
+  };
+
+  // Accumulates into the calling thread's codec_stats; merge threads with operator+=
+  struct stats_observer
+  {
+    static codec_stats &local() noexcept
+    {
+      thread_local codec_stats stats;
+      return stats;
+    }
+
+    void on_frame_encoded(std::size_t payload_size, std::size_t encoded_size) noexcept
+    {
+      codec_stats &s = local();
+      ++s.frames_encoded;
+      s.encode_bytes_in += payload_size;
+      s.encode_bytes_out += encoded_size;
+      s.max_frame_size = std::max<std::uint64_t>(s.max_frame_size, payload_size);
+    }
+
+    void on_frame_decoded(std::size_t encoded_size, std::size_t frame_size) noexcept
+    {
+      codec_stats &s = local();
+      ++s.frames_decoded;
+      s.decode_bytes_in += encoded_size;
+      s.decode_bytes_out += frame_size;
+      s.max_frame_size = std::max<std::uint64_t>(s.max_frame_size, frame_size);
+    }
+
+    void on_decode_error(decode_error e, std::size_t encoded_size) noexcept
+    {
+      codec_stats &s = local();
+      ++s.decode_errors[static_cast<std::size_t>(e)];
+      s.decode_bytes_in += encoded_size;
+    }
+
+    void on_resync(std::size_t skipped) noexcept
+    {
+      local().resync_bytes += skipped;
+    }
+  };
+
+  namespace
+  {
+    // COBS flavours sharing the views::encode / views::decode state machines
+    enum class cobs_variant
+    {
+      standard, // Plain COBS
+      reduced   // COBS/R: the last data byte may replace the final code byte
+    };
+
+    template <class T>
+    [[nodiscard]] constexpr std::byte to_byte(T v) noexcept
+    {
+      if constexpr (std::same_as<std::remove_cvref_t<T>, std::byte>)
+      {
+        return v;
+      }
+      else
+      {
+        return static_cast<std::byte>(static_cast<unsigned char>(v));
+      }
+    }
+
+    // Byte range of a frame: the frame itself, or each of its segments for gather lists
+    template <class Frame, bool = ByteRangeRange<Frame>>
+    struct segment_of
+    {
+      using type = Frame;
+    };
+
+    template <class Frame>
+    struct segment_of<Frame, true>
+    {
+      using type = std::ranges::range_value_t<Frame>;
+    };
+
+    struct no_segments
+    {
+    };
+
+    // Payload size of frame types whose length is fixed at compile time, 0 for everything else:
+    // byte arrays, static-extent byte spans and trivially copyable structs (encoded by their bytes).
+    // Structs must have unique object representations: padding bytes are indeterminate and would
+    // leak into the frame, and equal floating-point values can differ in their bytes.
+    template <class Frame>
+    struct fixed_frame_size : std::integral_constant<std::size_t, 0>
+    {
+    };
+
+    template <ByteLike B, std::size_t N>
+    struct fixed_frame_size<std::array<B, N>> : std::integral_constant<std::size_t, N>
+    {
+    };
+
+    template <ByteLike B, std::size_t N>
+      requires(N != std::dynamic_extent)
+    struct fixed_frame_size<std::span<B, N>> : std::integral_constant<std::size_t, N>
+    {
+    };
+
+    template <class Frame>
+      requires(
+          !std::ranges::range<Frame> && std::is_trivially_copyable_v<Frame> &&
+          std::has_unique_object_representations_v<Frame> && !ByteLike<Frame>
+      )
+    struct fixed_frame_size<Frame> : std::integral_constant<std::size_t, sizeof(Frame)>
+    {
+    };
+
+    template <class Frame>
+    concept FixedSizeFrame = 0 < fixed_frame_size<std::remove_cv_t<Frame>>::value;
+
+    template <class T>
+    concept FixedSizeFrameRange =
+        std::ranges::input_range<T> && FixedSizeFrame<std::ranges::range_value_t<T>>;
+
+    // Constant evaluation cannot reinterpret memory, so frames are copied out byte by byte there
+    template <class Frame>
+    [[nodiscard]] constexpr auto constant_frame_bytes(const Frame &frame) noexcept
+    {
+      std::array<std::byte, fixed_frame_size<Frame>::value> bytes{};
+      if constexpr (std::ranges::range<Frame>)
+      {
+        std::ranges::transform(frame, bytes.begin(), [](auto b) { return to_byte(b); });
+      }
+      else
+      {
+        bytes = std::bit_cast<decltype(bytes)>(frame);
+      }
+      return bytes;
+    }
+
+    template <class Frame>
+    [[nodiscard]] const std::byte *frame_bytes(const Frame &frame) noexcept
+    {
+      if constexpr (std::ranges::contiguous_range<Frame>)
+      {
+        return reinterpret_cast<const std::byte *>(std::ranges::data(frame));
+      }
+      else
+      {
+        return reinterpret_cast<const std::byte *>(std::addressof(frame));
+      }
+    }
+
+    // Iterator pairs that can be scanned as raw byte memory by the fast paths
+    template <class I, class S>
+    concept ContiguousBytes = std::contiguous_iterator<I> && std::sized_sentinel_for<S, I> &&
+                              ByteLike<std::iter_value_t<I>>;
+
+    template <class I>
+    [[nodiscard]] const std::byte *as_bytes_ptr(I it) noexcept
+    {
+      return reinterpret_cast<const std::byte *>(std::to_address(it));
+    }
+  } // anonymous namespace
+
+  // Contiguous-input kernels and their runtime selection. They live outside the anonymous namespace so
+  // that every translation unit shares one selected kernel table.
+  namespace kernels
+  {
+    using find_byte_fn = const std::byte *(*)(const std::byte *, const std::byte *, std::byte) noexcept;
+    using copy_xor_fn = void (*)(std::byte *, const std::byte *, std::size_t, std::byte) noexcept;
+
+    // Result of decode_blocks: complete COBS blocks decoded from src, stopping at a code byte
+    struct block_run
+    {
+      std::size_t consumed = 0;  // Input bytes, ending just before the next code byte or delimiter
+      std::size_t written = 0;   // Output bytes, excluding the last block's implicit zero
+      std::size_t last_code = 0; // Code of the last block; its implicit zero is left to the caller
+    };
+    using decode_blocks_fn =
+        block_run (*)(const std::byte *, std::size_t, std::byte *, std::size_t, std::byte) noexcept;
+
+    // Result of find_all: matches recorded and the input bytes scanned for them
+    struct match_run
+    {
+      std::size_t count = 0;
+      std::size_t scanned = 0;
+    };
+    using find_all_fn =
+        match_run (*)(const std::byte *, std::size_t, std::byte, std::uint32_t *, std::size_t) noexcept;
+    using crc32c_fn = std::uint32_t (*)(std::uint32_t, const std::byte *, std::size_t) noexcept;
+
+    // find_all scans whole windows of at most this many bytes and stops before one that could
+    // overflow the positions array, so callers pass room for at least this many positions
+    inline constexpr std::size_t find_all_window = 64;
+
+    // One implementation of every contiguous kernel per instruction set
+    struct kernel_table
+    {
+      simd_level level;
+      find_byte_fn find_byte;   // First position in [first, last) holding value, or last
+      copy_xor_fn copy_xor;     // Copies n bytes, XOR-ing each with key (delimiter translation)
+      find_all_fn find_all;     // Offsets of every occurrence of value in [first, first + n), in order
+      crc32c_fn crc32c_update;  // Advances a raw CRC32C register over n bytes
+      decode_blocks_fn decode_blocks = nullptr; // Optional: decodes runs of short blocks
+    };
+
+    namespace scalar
+    {
+      constexpr const std::byte *find_byte(
+          const std::byte *first,
+          const std::byte *last,
+          std::byte value
+      ) noexcept
+      {
+        while (first != last && *first != value)
+        {
+          ++first;
+        }
+        return first;
+      }
+
+      constexpr void copy_xor(std::byte *dst, const std::byte *src, std::size_t n, std::byte key) noexcept
+      {
+        if !consteval
+        {
+          if (key == std::byte{ 0 })
+          {
+            std::memcpy(dst, src, n);
+            return;
+          }
+        }
+        for (; n != 0; --n, ++src, ++dst)
+        {
+          *dst = *src ^ key;
+        }
+      }
+
+      inline match_run find_all(
+          const std::byte *first,
+          std::size_t n,
+          std::byte value,
+          std::uint32_t *positions,
+          std::size_t max
+      ) noexcept
+      {
+        match_run run{};
+        for (; run.scanned < n && run.count < max; ++run.scanned)
+        {
+          if (first[run.scanned] == value)
+          {
+            positions[run.count++] = static_cast<std::uint32_t>(run.scanned);
+          }
+        }
+        return run;
+      }
+
+      // CRC32C (Castagnoli, reflected polynomial 0x82F63B78) slicing-by-8 tables
+      inline constexpr auto crc32c_tables = [] {
+        std::array<std::array<std::uint32_t, 256>, 8> tables{};
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+          std::uint32_t crc = i;
+          for (int bit = 0; bit < 8; ++bit)
+          {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+          }
+          tables[0][i] = crc;
+        }
+        for (std::size_t slice = 1; slice < 8; ++slice)
+        {
+          for (std::size_t i = 0; i < 256; ++i)
+          {
+            std::uint32_t prev = tables[slice - 1][i];
+            tables[slice][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+          }
+        }
+        return tables;
+      }();
+
+      inline std::uint32_t crc32c_update(std::uint32_t crc, const std::byte *p, std::size_t n) noexcept
+      {
+        const auto &t = crc32c_tables;
+        auto at = [&p](std::size_t i) { return static_cast<std::uint32_t>(p[i]); };
+        for (; 8 <= n; n -= 8, p += 8)
+        {
+          std::uint32_t lo = crc ^ (at(0) | at(1) << 8 | at(2) << 16 | at(3) << 24);
+          std::uint32_t hi = at(4) | at(5) << 8 | at(6) << 16 | at(7) << 24;
+          crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        }
+        for (; n != 0; --n, ++p)
+        {
+          crc = t[0][(crc ^ static_cast<std::uint32_t>(*p)) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+      }
+    } // namespace scalar
+
+    // Word-at-a-time kernels for targets without vector units (haszero bit trick on 64-bit words)
+    namespace swar
+    {
+      inline constexpr std::uint64_t ones = 0x0101010101010101u;
+      inline constexpr std::uint64_t highs = 0x8080808080808080u;
+
+      inline std::uint64_t load_word(const std::byte *p) noexcept
+      {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+      }
+
+      // High bit set in every zero byte of word (and possibly in bytes above the first zero)
+      constexpr std::uint64_t zero_bytes(std::uint64_t word) noexcept
+      {
+        return (word - ones) & ~word & highs;
+      }
+
+      inline const std::byte *find_byte(
+          const std::byte *first,
+          const std::byte *last,
+          std::byte value
+      ) noexcept
+      {
+        const std::uint64_t pattern = ones * static_cast<std::uint64_t>(value);
+        while (8 <= last - first)
+        {
+          std::uint64_t hits = zero_bytes(load_word(first) ^ pattern);
+          if (hits != 0)
+          {
+            if constexpr (std::endian::native == std::endian::little)
+            {
+              // Spurious bits only appear above a real match, so the lowest one is exact
+              return first + std::countr_zero(hits) / 8;
+            }
+            else
+            {
+              return scalar::find_byte(first, first + 8, value);
+            }
+          }
+          first += 8;
+        }
+        return scalar::find_byte(first, last, value);
+      }
+
+      inline void copy_xor(std::byte *dst, const std::byte *src, std::size_t n, std::byte key) noexcept
+      {
+        if (key == std::byte{ 0 })
+        {
+          std::memcpy(dst, src, n);
+          return;
+        }
+        const std::uint64_t pattern = ones * static_cast<std::uint64_t>(key);
+        for (; 8 <= n; n -= 8, src += 8, dst += 8)
+        {
+          std::uint64_t word = load_word(src) ^ pattern;
+          std::memcpy(dst, &word, sizeof(word));
+        }
+        scalar::copy_xor(dst, src, n, key);
+      }
+    } // namespace swar
+
+#if defined(__SSE2__)
+    namespace sse2
+    {
+      inline const std::byte *find_byte(
+          const std::byte *first,
+          const std::byte *last,
+          std::byte value
+      ) noexcept
+      {
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+        while (16 <= last - first)
+        {
+          __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+          unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+          if (mask != 0)
+          {
+            return first + std::countr_zero(mask);
+          }
+          first += 16;
+        }
+        return scalar::find_byte(first, last, value);
+      }
+
+      inline void copy_xor(std::byte *dst, const std::byte *src, std::size_t n, std::byte key) noexcept
+      {
+        if (key == std::byte{ 0 })
+        {
+          std::memcpy(dst, src, n);
+          return;
+        }
+        const __m128i mask = _mm_set1_epi8(static_cast<char>(key));
+        for (; 16 <= n; n -= 16, src += 16, dst += 16)
+        {
+          __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_xor_si128(chunk, mask));
+        }
+        scalar::copy_xor(dst, src, n, key);
+      }
+
+      inline match_run find_all(
+          const std::byte *first,
+          std::size_t n,
+          std::byte value,
+          std::uint32_t *positions,
+          std::size_t max
+      ) noexcept
+      {
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+        match_run run{};
+        while (16 <= n - run.scanned && 16 <= max - run.count)
+        {
+          __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + run.scanned));
+          unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+          for (; mask != 0; mask &= mask - 1)
+          {
+            positions[run.count++] = static_cast<std::uint32_t>(run.scanned + std::countr_zero(mask));
+          }
+          run.scanned += 16;
+        }
+        std::size_t rest = std::min<std::size_t>(n - run.scanned, 16);
+        match_run tail =
+            scalar::find_all(first + run.scanned, rest, value, positions + run.count, max - run.count);
+        for (std::size_t i = 0; i < tail.count; ++i)
+        {
+          positions[run.count + i] += static_cast<std::uint32_t>(run.scanned);
+        }
+        return { run.count + tail.count, run.scanned + tail.scanned };
+      }
+    } // namespace sse2
+#endif
+
+#if defined(__SSE4_2__) || defined(MAMECOBS_X86_DISPATCH)
+    // The crc32 instruction; built with a target attribute so it is available without -msse4.2
+    namespace sse42
+    {
+      [[gnu::target("sse4.2")]] inline std::uint32_t crc32c_update(
+          std::uint32_t crc,
+          const std::byte *p,
+          std::size_t n
+      ) noexcept
+      {
+        for (; 8 <= n; n -= 8, p += 8)
+        {
+          std::uint64_t word;
+          std::memcpy(&word, p, sizeof(word));
+          crc = static_cast<std::uint32_t>(_mm_crc32_u64(crc, word));
+        }
+        for (; n != 0; --n, ++p)
+        {
+          crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*p));
+        }
+        return crc;
+      }
+    } // namespace sse42
+#endif
+
+#if defined(MAMECOBS_X86_DISPATCH)
+    // Compiled for the target ISA via function attributes; only called after cpuid has confirmed support
+    namespace avx2
+    {
+      [[gnu::target("avx2")]] inline const std::byte *find_byte(
+          const std::byte *first,
+          const std::byte *last,
+          std::byte value
+      ) noexcept
+      {
+        const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+        while (32 <= last - first)
+        {
+          __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+          unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+          if (mask != 0)
+          {
+            return first + std::countr_zero(mask);
+          }
+          first += 32;
+        }
+        return sse2::find_byte(first, last, value);
+      }
+
+      [[gnu::target("avx2")]] inline void copy_xor(
+          std::byte *dst,
+          const std::byte *src,
+          std::size_t n,
+          std::byte key
+      ) noexcept
+      {
+        if (key == std::byte{ 0 })
+        {
+          std::memcpy(dst, src, n);
+          return;
+        }
+        const __m256i mask = _mm256_set1_epi8(static_cast<char>(key));
+        for (; 32 <= n; n -= 32, src += 32, dst += 32)
+        {
+          __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_xor_si256(chunk, mask));
+        }
+        sse2::copy_xor(dst, src, n, key);
+      }
+
+      [[gnu::target("avx2")]] inline match_run find_all(
+          const std::byte *first,
+          std::size_t n,
+          std::byte value,
+          std::uint32_t *positions,
+          std::size_t max
+      ) noexcept
+      {
+        const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+        match_run run{};
+        while (32 <= n - run.scanned && 32 <= max - run.count)
+        {
+          __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + run.scanned));
+          unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+          for (; mask != 0; mask &= mask - 1)
+          {
+            positions[run.count++] = static_cast<std::uint32_t>(run.scanned + std::countr_zero(mask));
+          }
+          run.scanned += 32;
+        }
+        std::size_t rest = std::min<std::size_t>(n - run.scanned, 32);
+        match_run tail =
+            sse2::find_all(first + run.scanned, rest, value, positions + run.count, max - run.count);
+        for (std::size_t i = 0; i < tail.count; ++i)
+        {
+          positions[run.count + i] += static_cast<std::uint32_t>(run.scanned);
+        }
+        return { run.count + tail.count, run.scanned + tail.scanned };
+      }
+    } // namespace avx2
+
+    // AVX-512BW: masked loads and stores handle the tail without a scalar loop
+    namespace avx512
+    {
+      [[gnu::target("avx512f,avx512bw")]] inline const std::byte *find_byte(
+          const std::byte *first,
+          const std::byte *last,
+          std::byte value
+      ) noexcept
+      {
+        const __m512i needle = _mm512_set1_epi8(static_cast<char>(value));
+        while (first != last)
+        {
+          std::size_t n = std::min<std::size_t>(64, static_cast<std::size_t>(last - first));
+          __mmask64 valid = n == 64 ? ~__mmask64{ 0 } : (__mmask64{ 1 } << n) - 1;
+          __m512i chunk = _mm512_maskz_loadu_epi8(valid, first);
+          __mmask64 hits = _mm512_mask_cmpeq_epi8_mask(valid, chunk, needle);
+          if (hits != 0)
+          {
+            return first + std::countr_zero(hits);
+          }
+          first += n;
+        }
+        return last;
+      }
+
+      [[gnu::target("avx512f,avx512bw")]] inline void copy_xor(
+          std::byte *dst,
+          const std::byte *src,
+          std::size_t n,
+          std::byte key
+      ) noexcept
+      {
+        if (key == std::byte{ 0 })
+        {
+          std::memcpy(dst, src, n);
+          return;
+        }
+        const __m512i mask = _mm512_set1_epi8(static_cast<char>(key));
+        while (n != 0)
+        {
+          std::size_t step = std::min<std::size_t>(64, n);
+          __mmask64 valid = step == 64 ? ~__mmask64{ 0 } : (__mmask64{ 1 } << step) - 1;
+          __m512i chunk = _mm512_maskz_loadu_epi8(valid, src);
+          _mm512_mask_storeu_epi8(dst, valid, _mm512_xor_si512(chunk, mask));
+          n -= step;
+          src += step;
+          dst += step;
+        }
+      }
+
+      [[gnu::target("avx512f,avx512bw")]] inline match_run find_all(
+          const std::byte *first,
+          std::size_t n,
+          std::byte value,
+          std::uint32_t *positions,
+          std::size_t max
+      ) noexcept
+      {
+        const __m512i needle = _mm512_set1_epi8(static_cast<char>(value));
+        match_run run{};
+        while (run.scanned != n && 64 <= max - run.count)
+        {
+          std::size_t step = std::min<std::size_t>(64, n - run.scanned);
+          __mmask64 valid = step == 64 ? ~__mmask64{ 0 } : (__mmask64{ 1 } << step) - 1;
+          __m512i chunk = _mm512_maskz_loadu_epi8(valid, first + run.scanned);
+          std::uint64_t hits = _mm512_mask_cmpeq_epi8_mask(valid, chunk, needle);
+          for (; hits != 0; hits &= hits - 1)
+          {
+            positions[run.count++] = static_cast<std::uint32_t>(run.scanned + std::countr_zero(hits));
+          }
+          run.scanned += step;
+        }
+        return run;
+      }
+
+      // AVX-512 VBMI2 block decoder for frames with frequent zeros. Within a 64-byte window the code
+      // chain is walked to find every block that ends inside it; vpcompressb then drops the code bytes
+      // in one step, after a masked blend has turned those that stand for a zero into 0x00.
+      // Stops at the first block that is long, crosses the window or contains the delimiter.
+      [[gnu::target("avx512f,avx512bw,avx512vbmi2")]] inline block_run decode_blocks(
+          const std::byte *src,
+          std::size_t n,
+          std::byte *dst,
+          std::size_t room,
+          std::byte delim
+      ) noexcept
+      {
+        const __m512i key = _mm512_set1_epi8(static_cast<char>(delim));
+        block_run run{};
+        std::size_t prev_code = 0xFF; // The first code byte was not preceded by a block of this run
+
+        while (64 <= n - run.consumed && 64 <= room - run.written)
+        {
+          const std::byte *window = src + run.consumed;
+          __m512i raw = _mm512_loadu_si512(window);
+          std::uint64_t delims = _mm512_cmpeq_epi8_mask(raw, key);
+
+          // Walk the code chain: keep the data bytes, turn code bytes into the previous block's zero or
+          // drop them
+          std::uint64_t keep = 0;
+          std::uint64_t zeros = 0;
+          std::size_t pos = 0;
+          while (pos < 64)
+          {
+            std::size_t code = static_cast<std::size_t>(window[pos] ^ delim);
+            std::size_t next = pos + code;
+            if (code == 0 || 64 < next)
+            {
+              break;
+            }
+            std::uint64_t body = ((code == 64 ? 0 : std::uint64_t{ 1 } << code) - 2) << pos;
+            if ((delims & body) != 0)
+            {
+              break;
+            }
+            if (prev_code < 0xFF)
+            {
+              keep |= std::uint64_t{ 1 } << pos;
+              zeros |= std::uint64_t{ 1 } << pos;
+            }
+            keep |= body;
+            prev_code = code;
+            pos = next;
+          }
+
+          if (pos == 0)
+          {
+            break;
+          }
+
+          __m512i data = _mm512_mask_blend_epi8(zeros, _mm512_xor_si512(raw, key), _mm512_setzero_si512());
+          __m512i packed = _mm512_maskz_compress_epi8(keep, data);
+          std::size_t count = static_cast<std::size_t>(std::popcount(keep));
+          __mmask64 out = count == 64 ? ~__mmask64{ 0 } : (__mmask64{ 1 } << count) - 1;
+          _mm512_mask_storeu_epi8(dst + run.written, out, packed);
+
+          run.consumed += pos;
+          run.written += count;
+          run.last_code = prev_code;
+        }
+        return run;
+      }
+    } // namespace avx512
+#endif
+
+    // Kernel registry: the table for a level, or nullptr when it is not compiled in or not supported by
+    // this CPU
+    inline const kernel_table *table_for(simd_level level) noexcept
+    {
+      static constexpr kernel_table scalar_table{
+        simd_level::scalar, scalar::find_byte, scalar::copy_xor, scalar::find_all, scalar::crc32c_update
+      };
+      static constexpr kernel_table swar_table{
+        simd_level::swar, swar::find_byte, swar::copy_xor, scalar::find_all, scalar::crc32c_update
+      };
+#if defined(__SSE2__)
+      static constexpr kernel_table sse2_table{
+        simd_level::sse2, sse2::find_byte, sse2::copy_xor, sse2::find_all, scalar::crc32c_update
+      };
+#endif
+#if defined(MAMECOBS_X86_DISPATCH)
+      // Every AVX2 / AVX-512 CPU also has SSE4.2
+      static constexpr kernel_table sse42_table{
+        simd_level::sse2, sse2::find_byte, sse2::copy_xor, sse2::find_all, sse42::crc32c_update
+      };
+      static constexpr kernel_table avx2_table{
+        simd_level::avx2, avx2::find_byte, avx2::copy_xor, avx2::find_all, sse42::crc32c_update
+      };
+      static constexpr kernel_table avx512_table{
+        simd_level::avx512, avx512::find_byte, avx512::copy_xor, avx512::find_all, sse42::crc32c_update
+      };
+      static constexpr kernel_table avx512_vbmi2_table{
+        simd_level::avx512, avx512::find_byte, avx512::copy_xor, avx512::find_all, sse42::crc32c_update,
+        avx512::decode_blocks
+      };
+#endif
+
+      switch (level)
+      {
+      case simd_level::scalar:
+        return &scalar_table;
+      case simd_level::swar:
+        return &swar_table;
+#if defined(MAMECOBS_X86_DISPATCH)
+      case simd_level::sse2:
+        return __builtin_cpu_supports("sse4.2") ? &sse42_table : &sse2_table;
+#elif defined(__SSE2__)
+      case simd_level::sse2:
+        return &sse2_table;
+#endif
+#if defined(MAMECOBS_X86_DISPATCH)
+      case simd_level::avx2:
+        return __builtin_cpu_supports("avx2") ? &avx2_table : nullptr;
+      case simd_level::avx512:
+        if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw"))
+        {
+          return nullptr;
+        }
+        return __builtin_cpu_supports("avx512vbmi2") ? &avx512_vbmi2_table : &avx512_table;
+#endif
+      default:
+        return nullptr;
+      }
+    }
+
+    // Parses a MAMECOBS_SIMD value; nullopt for unknown names
+    inline std::optional<simd_level> parse_simd_level(std::string_view name) noexcept
+    {
+      constexpr std::pair<std::string_view, simd_level> names[] = {
+        { "scalar", simd_level::scalar },
+        { "swar", simd_level::swar },
+        { "sse2", simd_level::sse2 },
+        { "avx2", simd_level::avx2 },
+        { "avx512", simd_level::avx512 },
+      };
+      for (const auto &[key, level] : names)
+      {
+        if (key == name)
+        {
+          return level;
+        }
+      }
+      return std::nullopt;
+    }
+
+    // Best supported table not above limit
+    inline const kernel_table &select_kernels(simd_level limit) noexcept
+    {
+      for (int level = static_cast<int>(limit); 0 < level; --level)
+      {
+        if (const kernel_table *table = table_for(static_cast<simd_level>(level)))
+        {
+          return *table;
+        }
+      }
+      return *table_for(simd_level::scalar);
+    }
+
+    // MAMECOBS_SIMD=scalar|swar|sse2|avx2|avx512 caps the level for testing.
+    // Kept out of line so the one-time initialisation does not bloat the inlined callers.
+    [[gnu::noinline]] inline const kernel_table &select_active_kernels() noexcept
+    {
+      const char *env = std::getenv("MAMECOBS_SIMD");
+      std::optional<simd_level> limit = env ? parse_simd_level(env) : std::nullopt;
+      return select_kernels(limit.value_or(simd_level::avx512));
+    }
+
+    // Selected once on first use, for the whole program
+    inline const kernel_table &active_kernels() noexcept
+    {
+      static const kernel_table &table = select_active_kernels();
+      return table;
+    }
+
+    // Short runs dominate frames with frequent zeros, so they are handled inline before dispatching
+    inline constexpr std::size_t inline_run = 16;
+
+    // Both are usable in constant expressions, where they fall back to the scalar loops. The inline
+    // short-run paths use no instruction set above the selected level, so a MAMECOBS_SIMD cap holds.
+    [[nodiscard]] constexpr const std::byte *find_byte(
+        const std::byte *first,
+        const std::byte *last,
+        std::byte value
+    ) noexcept
+    {
+      if consteval
+      {
+        return scalar::find_byte(first, last, value);
+      }
+      const kernel_table &active = active_kernels();
+#if defined(__SSE2__)
+      if (simd_level::sse2 <= active.level && inline_run <= static_cast<std::size_t>(last - first))
+      {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(static_cast<char>(value))))
+        );
+        if (mask != 0)
+        {
+          return first + std::countr_zero(mask);
+        }
+        first += inline_run;
+      }
+#endif
+      if (static_cast<std::size_t>(last - first) < inline_run)
+      {
+        return active.level == simd_level::scalar ? scalar::find_byte(first, last, value)
+                                                  : swar::find_byte(first, last, value);
+      }
+      return active.find_byte(first, last, value);
+    }
+
+    constexpr void copy_xor(std::byte *dst, const std::byte *src, std::size_t n, std::byte key) noexcept
+    {
+      if consteval
+      {
+        scalar::copy_xor(dst, src, n, key);
+        return;
+      }
+      if (n < inline_run)
+      {
+        scalar::copy_xor(dst, src, n, key);
+        return;
+      }
+      active_kernels().copy_xor(dst, src, n, key);
+    }
+
+    // Advances a raw (pre-inverted) CRC32C register over n bytes; the crc32 instruction is used
+    // when the build targets SSE4.2, otherwise the selected kernel table decides at runtime
+    [[nodiscard]] inline std::uint32_t crc32c_update(
+        std::uint32_t crc,
+        const std::byte *p,
+        std::size_t n
+    ) noexcept
+    {
+#if defined(__SSE4_2__)
+      return sse42::crc32c_update(crc, p, n);
+#else
+      return active_kernels().crc32c_update(crc, p, n);
+#endif
+    }
+  } // namespace kernels
+
+  namespace
+  {
+    // Checksum policies: appended inside the encoded frame by encode<Checksum>() and
+    // verified and stripped by decode<MaxFrameSize, Checksum>().
+    // A policy provides digest_size, update(const std::byte *, std::size_t) and
+    // digest() -> std::array<std::byte, digest_size>; a default-constructed policy starts a new frame.
+    struct no_checksum
+    {
+      static constexpr std::size_t digest_size = 0;
+
+      constexpr void update(const std::byte *, std::size_t) noexcept
+      {
+      }
+
+      constexpr std::array<std::byte, 0> digest() const noexcept
+      {
+        return {};
+      }
+    };
+
+    // CRC32C, appended little-endian; uses the SSE4.2 crc32 instruction when available
+    class crc32c
+    {
+      std::uint32_t crc_ = 0xFFFFFFFFu;
+
+    public:
+      static constexpr std::size_t digest_size = 4;
+
+      void update(const std::byte *p, std::size_t n) noexcept
+      {
+        crc_ = kernels::crc32c_update(crc_, p, n);
+      }
+
+      std::uint32_t value() const noexcept
+      {
+        return ~crc_;
+      }
+
+      std::array<std::byte, digest_size> digest() const noexcept
+      {
+        std::uint32_t v = value();
+        return { static_cast<std::byte>(v),
+                 static_cast<std::byte>(v >> 8),
+                 static_cast<std::byte>(v >> 16),
+                 static_cast<std::byte>(v >> 24) };
+      }
+    };
+
+    // COBS/ZPE code layout
+    namespace zpe
+    {
+      inline constexpr std::size_t max_run = 0xDF;      // 0xE0: run without zero, 0x01-0xDF: run + one zero
+      inline constexpr std::size_t max_pair_run = 0x1E; // 0xE1-0xFF: run + two zeros
+      inline constexpr std::size_t run_code = 0xE0;
+      inline constexpr std::size_t pair_code = 0xE1;
+    } // namespace zpe
+
+    // Runs a Checksum over the bytes of a frame as they are decoded. The last digest_size bytes seen
+    // are held back until more follow, since at the delimiter they are the trailer, not payload.
+    template <class Checksum>
+    class trailer_checksum
+    {
+      static constexpr std::size_t digest_size = Checksum::digest_size;
+
+      [[no_unique_address]] Checksum checksum_;
+      std::array<std::byte, digest_size> held_{};
+      std::size_t held_size_ = 0;
+
+    public:
+      constexpr void reset()
+      {
+        checksum_ = Checksum{};
+        held_size_ = 0;
+      }
+
+      constexpr void update(const std::byte *p, std::size_t n)
+      {
+        if constexpr (digest_size != 0)
+        {
+          if (digest_size <= n)
+          {
+            checksum_.update(held_.data(), held_size_);
+            checksum_.update(p, n - digest_size);
+            std::copy_n(p + (n - digest_size), digest_size, held_.begin());
+            held_size_ = digest_size;
+            return;
+          }
+          std::size_t spill = held_size_ + n <= digest_size ? 0 : held_size_ + n - digest_size;
+          checksum_.update(held_.data(), spill);
+          std::copy(held_.begin() + spill, held_.begin() + held_size_, held_.begin());
+          held_size_ -= spill;
+          std::copy_n(p, n, held_.begin() + held_size_);
+          held_size_ += n;
+        }
+      }
+
+      // True when the bytes held back are the digest of everything before them
+      constexpr bool matches() const
+      {
+        auto digest = checksum_.digest();
+        return held_size_ == digest_size && std::equal(digest.begin(), digest.end(), held_.begin());
+      }
+    };
+
+    // Width of the fixed-size copy the unchecked loop uses for short blocks
+    inline constexpr std::size_t unchecked_window = 32;
+
+    // Bytes a whole-frame Loop may write past the end of the frame: the branch-light loop stores before
+    // it checks the size, the unchecked loop copies short blocks a whole window at a time
+    template <class Loop>
+    inline constexpr std::size_t loop_slack = std::same_as<Loop, branch_light_loop> ? 1
+                                              : std::same_as<Loop, unchecked_loop>  ? unchecked_window
+                                                                                    : 0;
+
+    // COBS block parser shared by the decoders: walks wait_for_code / read_data_bytes / handle_zero over
+    // the input, keeps the stream bookkeeping of frame_error, verifies and strips Checksum trailers,
+    // reports to the Observer and resynchronises after errors. A failed frame is reported as soon as
+    // the error is detected; the rest of it is skipped at the start of the next call. Decoded bytes go
+    // to an Output:
+    //   begin_frame()                    a frame starts; called before its first input byte is consumed
+    //   room() -> std::span<std::byte>   where the next bytes go; empty when the frame cannot grow
+    //   commit(std::size_t n)            the first n bytes of room() have been written
+    //   overflow() -> decode_error       the error of a frame that outgrows room()
+    //   end_frame(std::uint64_t size) -> std::optional<decode_error>
+    //                                    the delimiter closed a frame of size payload bytes; may reject it
+    //   fail_frame(const frame_error &)  the frame failed
+    // next() runs up to the next frame, error or the end of the input; step() does the same within a
+    // budget of input bytes and picks up where it stopped on the next call.
+    template <class BaseIter,
+              class BaseSent,
+              cobs_variant Variant = cobs_variant::standard,
+              class Checksum = no_checksum,
+              class Observer = null_observer>
+    class block_parser
+    {
+      BaseIter it_;
+      BaseSent end_;
+      std::byte delim_; // Every input byte is XOR-ed with the delimiter
+
+      // Vector decoder for runs of short blocks, when the input is contiguous and the CPU has one
+      kernels::decode_blocks_fn decode_blocks_ = nullptr;
+
+      trailer_checksum<Checksum> checksum_;
+      [[no_unique_address]] Observer observer_;
+
+      // Stream position bookkeeping for frame_error
+      std::uint64_t offset_ = 0;      // Input bytes consumed so far
+      std::uint64_t frame_start_ = 0; // offset_ at the start of the current frame
+      std::uint64_t frame_index_ = 0;
+      std::uint64_t frame_size_ = 0;   // Bytes decoded into the current frame, trailer included
+      std::uint64_t limit_ = 0;        // step(): offset_ at which the budget runs out
+      std::uint64_t resync_bytes_ = 0; // Input skipped while resynchronising, as told to on_resync()
+      decode_error error_kind_ = decode_error::incomplete;
+      frame_error failure_{ decode_error::incomplete };
+
+      enum class parse_state
+      {
+        wait_for_code,
+        read_data_bytes,
+        handle_zero,
+        resync,         // Skipping the rest of a failed frame, from frame_start_
+        frame_complete, // The delimiter closed the frame
+        error_state,    // error_kind_ ended the frame
+        finished,
+        pending // Out of budget; resume_ is where to continue
+      };
+      parse_state state_ = parse_state::wait_for_code;
+      parse_state resume_ = parse_state::wait_for_code;
+
+      std::size_t code_ = 0;
+      std::size_t bytes_read_ = 0;
+
+      template <bool Budgeted>
+      constexpr bool out_of_budget(parse_state resume) noexcept
+      {
+        if constexpr (Budgeted)
+        {
+          if (offset_ == limit_)
+          {
+            resume_ = resume;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      template <bool Budgeted>
+      constexpr std::size_t budget_left() const noexcept
+      {
+        if constexpr (Budgeted)
+        {
+          return static_cast<std::size_t>(std::min<std::uint64_t>(limit_ - offset_, SIZE_MAX));
+        }
+        return SIZE_MAX;
+      }
+
+      constexpr parse_state fail(decode_error kind) noexcept
+      {
+        error_kind_ = kind;
+        return parse_state::error_state;
+      }
+
+      template <class Output>
+      constexpr void commit(Output &out, const std::byte *p, std::size_t n)
+      {
+        out.commit(n);
+        frame_size_ += n;
+        checksum_.update(p, n);
+      }
+
+      constexpr void next_frame()
+      {
+        ++frame_index_;
+        frame_start_ = offset_;
+        frame_size_ = 0;
+        checksum_.reset();
+        state_ = parse_state::wait_for_code;
+      }
+
+      // Decodes up to want data bytes of the current block to dst, stopping early at a delimiter or at
+      // the end of the input; returns the number of bytes written
+      constexpr std::size_t copy_run(std::byte *dst, std::size_t want)
+      {
+        std::size_t n = 0;
+        if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+        {
+          if !consteval
+          {
+            const std::byte *first = as_bytes_ptr(it_);
+            std::size_t avail = std::min(want, static_cast<std::size_t>(end_ - it_));
+            n = static_cast<std::size_t>(kernels::find_byte(first, first + avail, delim_) - first);
+            kernels::copy_xor(dst, first, n, delim_);
+            it_ += static_cast<std::iter_difference_t<BaseIter>>(n);
+            offset_ += n;
+            bytes_read_ += n;
+            return n;
+          }
+        }
+        for (; n < want && it_ != end_; ++n, ++it_)
+        {
+          std::byte b = to_byte(*it_);
+          if (b == delim_)
+          {
+            break;
+          }
+          dst[n] = b ^ delim_;
+        }
+        offset_ += n;
+        bytes_read_ += n;
+        return n;
+      }
+
+      // Contiguous fast path: decode a run of short blocks with the vector kernel, leaving the
+      // last block's implicit zero to process_handle_zero
+      template <class Output>
+      constexpr bool decode_short_blocks(Output &out)
+      {
+        if consteval
+        {
+          return false; // Fast paths need raw pointers and the vector kernels
+        }
+        if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+        {
+          // The kernel works on whole 64-byte windows of input and output
+          std::span<std::byte> dst = out.room();
+          if (end_ - it_ < 64 || dst.size() < 64)
+          {
+            return false;
+          }
+          kernels::block_run run = decode_blocks_(
+              as_bytes_ptr(it_),
+              static_cast<std::size_t>(end_ - it_),
+              dst.data(),
+              dst.size(),
+              delim_
+          );
+          if (run.consumed == 0)
+          {
+            return false;
+          }
+          it_ += static_cast<std::iter_difference_t<BaseIter>>(run.consumed);
+          offset_ += run.consumed;
+          commit(out, dst.data(), run.written);
+          code_ = run.last_code;
+          bytes_read_ = code_ - 1;
+          return true;
+        }
+        return false;
+      }
+
+      template <bool Budgeted, class Output>
+      constexpr parse_state process_wait_for_code(Output &out)
+      {
+        if (it_ == end_)
+        {
+          // Input that ends inside a frame leaves it incomplete, even right after a full 254-byte block
+          return offset_ == frame_start_ ? parse_state::finished : fail(decode_error::incomplete);
+        }
+        if (out_of_budget<Budgeted>(parse_state::wait_for_code))
+        {
+          return parse_state::pending;
+        }
+        if (offset_ == frame_start_)
+        {
+          out.begin_frame();
+        }
+
+        // Only worth trying when the next block is short enough to fit a window
+        if constexpr (!Budgeted)
+        {
+          if (decode_blocks_ && static_cast<std::size_t>(to_byte(*it_) ^ delim_) - 1 < 63 &&
+              decode_short_blocks(out))
+          {
+            return parse_state::handle_zero;
+          }
+        }
+
+        std::byte code_byte = to_byte(*it_);
+        ++it_;
+        ++offset_;
+        if (code_byte == delim_)
+        {
+          return parse_state::frame_complete;
+        }
+
+        code_ = static_cast<std::size_t>(code_byte ^ delim_);
+        bytes_read_ = 0;
+        return parse_state::read_data_bytes;
+      }
+
+      template <bool Budgeted, class Output>
+      constexpr parse_state process_read_data_bytes(Output &out)
+      {
+        while (bytes_read_ < code_ - 1)
+        {
+          if (it_ == end_)
+          {
+            return fail(decode_error::incomplete);
+          }
+          if (out_of_budget<Budgeted>(parse_state::read_data_bytes))
+          {
+            return parse_state::pending;
+          }
+          std::span<std::byte> dst = out.room();
+          if (dst.empty())
+          {
+            return fail(out.overflow());
+          }
+
+          std::size_t want = std::min({ code_ - 1 - bytes_read_, dst.size(), budget_left<Budgeted>() });
+          std::size_t n = copy_run(dst.data(), want);
+          commit(out, dst.data(), n);
+          if (n < want && it_ != end_)
+          {
+            if constexpr (Variant == cobs_variant::reduced)
+            {
+              return process_reduced_tail(out);
+            }
+            return fail(decode_error::invalid_cobs); // A delimiter inside the block
+          }
+        }
+        return parse_state::handle_zero;
+      }
+
+      // COBS/R: a block cut short by the delimiter carries its last data byte in the code
+      template <class Output>
+      constexpr parse_state process_reduced_tail(Output &out)
+      {
+        std::span<std::byte> dst = out.room();
+        if (dst.empty())
+        {
+          return fail(out.overflow());
+        }
+        dst[0] = static_cast<std::byte>(code_);
+        commit(out, dst.data(), 1);
+        ++it_;
+        ++offset_;
+        return parse_state::frame_complete;
+      }
+
+      template <bool Budgeted, class Output>
+      constexpr parse_state process_handle_zero(Output &out)
+      {
+        if (255 <= code_)
+        {
+          return parse_state::wait_for_code;
+        }
+        if (it_ == end_)
+        {
+          return fail(decode_error::incomplete);
+        }
+        if (out_of_budget<Budgeted>(parse_state::handle_zero))
+        {
+          return parse_state::pending;
+        }
+
+        if (to_byte(*it_) == delim_)
+        {
+          ++it_;
+          ++offset_;
+          return parse_state::frame_complete;
+        }
+
+        std::span<std::byte> dst = out.room();
+        if (dst.empty())
+        {
+          return fail(out.overflow());
+        }
+        dst[0] = std::byte{ 0 };
+        commit(out, dst.data(), 1);
+        return parse_state::wait_for_code;
+      }
+
+      constexpr void resynced(std::uint64_t skipped)
+      {
+        resync_bytes_ += skipped;
+        observer_.on_resync(static_cast<std::size_t>(skipped));
+      }
+
+      // Skips input through the next delimiter, then reports the bytes skipped to the observer
+      template <bool Budgeted>
+      constexpr parse_state process_resync()
+      {
+        while (it_ != end_)
+        {
+          if (out_of_budget<Budgeted>(parse_state::resync))
+          {
+            return parse_state::pending;
+          }
+          if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+          {
+            if !consteval
+            {
+              const std::byte *first = as_bytes_ptr(it_);
+              std::size_t avail = std::min(budget_left<Budgeted>(), static_cast<std::size_t>(end_ - it_));
+              std::size_t n =
+                  static_cast<std::size_t>(kernels::find_byte(first, first + avail, delim_) - first);
+              it_ += static_cast<std::iter_difference_t<BaseIter>>(n);
+              offset_ += n;
+              if (n == avail)
+              {
+                continue; // End of the input or of the budget
+              }
+            }
+          }
+
+          std::byte b = to_byte(*it_);
+          ++it_;
+          ++offset_;
+          if (b == delim_)
+          {
+            break;
+          }
+        }
+        resynced(offset_ - frame_start_);
+        frame_start_ = offset_;
+        return parse_state::wait_for_code;
+      }
+
+      // Branch-light loop over a whole frame: every non-delimiter byte is stored (a zero in place of a
+      // code byte) and the output position advances by 0 or 1, so the only branches left are the
+      // delimiter and the size limit, both almost always not taken
+      template <class Output>
+      constexpr parse_state process_frame_branch_light(Output &out)
+      {
+        constexpr std::size_t capacity = Output::capacity;
+        out.begin_frame();
+        std::byte *buffer = out.data();
+        std::size_t remaining = 0; // Data bytes left in the current block
+        std::size_t zero = 0;      // 1 when the previous block ends in an implicit zero
+        std::size_t pos = 0;
+
+        while (it_ != end_)
+        {
+          std::byte b = to_byte(*it_);
+          if (b == delim_)
+          {
+            if (remaining != 0)
+            {
+              return fail(capacity <= pos ? decode_error::oversized : decode_error::invalid_cobs);
+            }
+            ++it_;
+            ++offset_;
+            commit(out, buffer, pos);
+            return parse_state::frame_complete;
+          }
+
+          std::byte value = b ^ delim_;
+          std::size_t is_code = remaining == 0 ? 1 : 0;
+          std::size_t advance = is_code ? zero : 1;
+          if (capacity < pos + advance)
+          {
+            return fail(decode_error::oversized);
+          }
+
+          buffer[pos] = is_code ? std::byte{ 0 } : value;
+          pos += advance;
+          zero = is_code ? (value != std::byte{ 255 } ? 1 : 0) : zero;
+          remaining = is_code ? static_cast<std::size_t>(value) - 1 : remaining - 1;
+          ++it_;
+          ++offset_;
+        }
+
+        // End of input, as the state machine sees it: nothing read ends the stream, anything else
+        // is an incomplete frame
+        return offset_ == frame_start_ ? parse_state::finished : fail(decode_error::incomplete);
+      }
+
+      // Unchecked loop over a whole frame: each code byte is taken at its word and the block behind it
+      // is copied without looking at the bytes. Only the ends of the input and of the frame buffer are
+      // checked, once per block, so malformed input gives unspecified frames and errors but is never
+      // read or written out of bounds. Valid input decodes exactly as the state machine decodes it;
+      // oversized and truncated frames are reported at the start of the block that did not fit.
+      template <class Output>
+      constexpr parse_state process_frame_unchecked(Output &out)
+      {
+        constexpr std::size_t capacity = Output::capacity;
+        out.begin_frame();
+        std::byte *buffer = out.data();
+        std::size_t pos = 0;
+        while (it_ != end_)
+        {
+          std::byte code_byte = to_byte(*it_);
+          ++it_;
+          ++offset_;
+          if (code_byte == delim_)
+          {
+            commit(out, buffer, pos);
+            return parse_state::frame_complete;
+          }
+
+          // The delimiter was handled above, so the code is 1-255 and n is at most 254
+          std::size_t n = static_cast<std::size_t>(code_byte ^ delim_) - 1;
+          if (capacity - pos < n)
+          {
+            return fail(decode_error::oversized);
+          }
+
+          bool copied = false;
+          if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+          {
+            if !consteval
+            {
+              std::size_t avail = static_cast<std::size_t>(end_ - it_);
+              if (avail < n)
+              {
+                return fail(decode_error::incomplete);
+              }
+              // Short blocks: a constant-size copy compiles to a few vector moves instead of a call
+              if (n <= unchecked_window && unchecked_window <= avail)
+              {
+                std::array<std::byte, unchecked_window> window;
+                std::memcpy(window.data(), as_bytes_ptr(it_), unchecked_window);
+                for (auto &b : window)
+                {
+                  b ^= delim_;
+                }
+                std::memcpy(buffer + pos, window.data(), unchecked_window);
+              }
+              else
+              {
+                kernels::copy_xor(buffer + pos, as_bytes_ptr(it_), n, delim_);
+              }
+              it_ += static_cast<std::iter_difference_t<BaseIter>>(n);
+              copied = true;
+            }
+          }
+          if (!copied)
+          {
+            for (std::size_t i = 0; i < n; ++i, ++it_)
+            {
+              if (it_ == end_)
+              {
+                offset_ += i;
+                return fail(decode_error::incomplete);
+              }
+              buffer[pos + i] = to_byte(*it_) ^ delim_;
+            }
+          }
+          pos += n;
+          offset_ += n;
+
+          // Every block but a full one ends in a zero, unless the frame ends with it
+          if (n != 254)
+          {
+            if (it_ == end_)
+            {
+              return fail(decode_error::incomplete);
+            }
+            if (to_byte(*it_) != delim_)
+            {
+              if (pos == capacity)
+              {
+                return fail(decode_error::oversized);
+              }
+              buffer[pos++] = std::byte{ 0 };
+            }
+          }
+        }
+
+        return offset_ == frame_start_ ? parse_state::finished : fail(decode_error::incomplete);
+      }
+
+      template <class Output>
+      constexpr step_status report_failure(Output &out, std::uint64_t at)
+      {
+        failure_ = frame_error{ error_kind_, at, frame_index_, offset_ - frame_start_ };
+        out.fail_frame(failure_);
+        next_frame();
+        return step_status::error;
+      }
+
+      // Reports a frame as soon as it fails. When the failing byte is its delimiter, the delimiter is
+      // consumed with it; otherwise the rest of the frame is skipped on the next call
+      template <bool Budgeted, class Output>
+      constexpr step_status report_and_resync(Output &out)
+      {
+        std::uint64_t at = offset_;
+        observer_.on_decode_error(error_kind_, static_cast<std::size_t>(offset_ - frame_start_));
+        if (it_ == end_)
+        {
+          resynced(0);
+          return report_failure(out, at);
+        }
+        if (budget_left<Budgeted>() != 0 && to_byte(*it_) == delim_)
+        {
+          ++it_;
+          ++offset_;
+          resynced(1);
+          return report_failure(out, at);
+        }
+        step_status status = report_failure(out, at);
+        state_ = parse_state::resync;
+        return status;
+      }
+
+      template <class Output>
+      constexpr step_status complete_frame(Output &out)
+      {
+        std::uint64_t size = frame_size_;
+        std::optional<decode_error> error;
+        if constexpr (Checksum::digest_size != 0)
+        {
+          if (!checksum_.matches())
+          {
+            error = decode_error::checksum_mismatch;
+          }
+          else
+          {
+            size -= Checksum::digest_size;
+          }
+        }
+        if (!error)
+        {
+          error = out.end_frame(size);
+        }
+
+        if (error)
+        {
+          // Detected on the delimiter, which has already been consumed
+          error_kind_ = *error;
+          observer_.on_decode_error(error_kind_, static_cast<std::size_t>(offset_ - frame_start_));
+          return report_failure(out, offset_ - 1);
+        }
+        observer_.on_frame_decoded(
+            static_cast<std::size_t>(offset_ - frame_start_),
+            static_cast<std::size_t>(size)
+        );
+        next_frame();
+        return step_status::frame;
+      }
+
+      template <class Loop, bool Budgeted, class Output>
+      constexpr step_status run(Output &out)
+      {
+        if (state_ == parse_state::resync)
+        {
+          state_ = process_resync<Budgeted>();
+        }
+
+        if constexpr (Variant == cobs_variant::standard && std::same_as<Loop, branch_light_loop>)
+        {
+          if (state_ == parse_state::wait_for_code)
+          {
+            state_ = process_frame_branch_light(out);
+          }
+        }
+        else if constexpr (Variant == cobs_variant::standard && std::same_as<Loop, unchecked_loop>)
+        {
+          if (state_ == parse_state::wait_for_code)
+          {
+            state_ = process_frame_unchecked(out);
+          }
+        }
+
+        while (true)
+        {
+          switch (state_)
+          {
+          case parse_state::wait_for_code:
+            state_ = process_wait_for_code<Budgeted>(out);
+            break;
+
+          case parse_state::read_data_bytes:
+            state_ = process_read_data_bytes<Budgeted>(out);
+            break;
+
+          case parse_state::handle_zero:
+            state_ = process_handle_zero<Budgeted>(out);
+            break;
+
+          case parse_state::resync:
+            state_ = process_resync<Budgeted>();
+            break;
+
+          case parse_state::frame_complete:
+            return complete_frame(out);
+
+          case parse_state::error_state:
+            return report_and_resync<Budgeted>(out);
+
+          case parse_state::finished:
+            state_ = parse_state::wait_for_code;
+            return step_status::finished;
+
+          case parse_state::pending:
+            state_ = resume_;
+            return step_status::pending;
+          }
+        }
+      }
+
+    public:
+      block_parser() = default;
+      constexpr block_parser(BaseIter it, BaseSent end, std::byte delim)
+          : it_(std::move(it))
+          , end_(std::move(end))
+          , delim_(delim)
+      {
+      }
+
+      // Enables the vector short-block decoder, for outputs whose room() has no side effects
+      constexpr void use_block_kernel(kernels::decode_blocks_fn decode_blocks) noexcept
+      {
+        decode_blocks_ = decode_blocks;
+      }
+
+      // Decodes up to the next frame or error, or to the end of the input (step_status::finished)
+      template <class Loop = state_machine_loop, class Output>
+      constexpr step_status next(Output &out)
+      {
+        return run<Loop, false>(out);
+      }
+
+      // Like next(), consuming at most max_bytes input bytes; step_status::pending when they run out first
+      template <class Output>
+      constexpr step_status step(Output &out, std::size_t max_bytes)
+      {
+        limit_ = max_bytes < UINT64_MAX - offset_ ? offset_ + max_bytes : UINT64_MAX;
+        return run<state_machine_loop, true>(out);
+      }
+
+      // The failure reported by the last step_status::error
+      constexpr const frame_error &error() const noexcept
+      {
+        return failure_;
+      }
+
+      // Input bytes consumed so far
+      constexpr std::uint64_t offset() const noexcept
+      {
+        return offset_;
+      }
+
+      // Input bytes skipped while resynchronising so far, the total Observer::on_resync() is told
+      constexpr std::uint64_t resync_bytes() const noexcept
+      {
+        return resync_bytes_;
+      }
+    };
+
+    // Output of views::decode and step_decoder: frames are decoded into a buffer of Capacity bytes, plus
+    // Slack bytes the whole-frame loops may write past it
+    template <std::size_t Capacity, std::size_t Slack = 0>
+    class buffer_output
+    {
+      std::array<std::byte, Capacity + Slack> buffer_;
+      std::size_t size_ = 0;
+
+    public:
+      static constexpr std::size_t capacity = Capacity;
+
+      constexpr void begin_frame() noexcept
+      {
+        size_ = 0;
+      }
+
+      constexpr std::span<std::byte> room() noexcept
+      {
+        return { buffer_.data() + size_, Capacity - size_ };
+      }
+
+      constexpr void commit(std::size_t n) noexcept
+      {
+        size_ += n;
+      }
+
+      static constexpr decode_error overflow() noexcept
+      {
+        return decode_error::oversized;
+      }
+
+      // Drops a checksum trailer from the frame
+      constexpr std::optional<decode_error> end_frame(std::uint64_t size) noexcept
+      {
+        size_ = static_cast<std::size_t>(size);
+        return std::nullopt;
+      }
+
+      constexpr void fail_frame(const frame_error &) noexcept
+      {
+      }
+
+      constexpr std::byte *data() noexcept
+      {
+        return buffer_.data();
+      }
+
+      constexpr std::span<const std::byte> frame() const noexcept
+      {
+        return { buffer_.data(), size_ };
+      }
+    };
+
+    // Output of views::decode_segmented: decoded bytes collect in a segment of SegmentSize bytes, handed
+    // to the FrameSink whenever it is full and when the frame ends
+    template <std::size_t SegmentSize, class Sink>
+    class segment_output
+    {
+      Sink *sink_ = nullptr;
+      std::array<std::byte, SegmentSize> segment_; // Decoded bytes not yet handed to the sink
+      std::size_t segment_size_ = 0;
+      std::uint64_t frame_size_ = 0; // Size of the last frame completed
+
+      void flush()
+      {
+        if (segment_size_ != 0)
+        {
+          sink_->data(std::span<const std::byte>(segment_.data(), segment_size_));
+          segment_size_ = 0;
+        }
+      }
+
+    public:
+      segment_output() = default;
+      explicit segment_output(Sink *sink) noexcept
+          : sink_(sink)
+      {
+      }
+
+      void begin_frame()
+      {
+        segment_size_ = 0;
+        sink_->begin_frame();
+      }
+
+      // Hands a full segment to the sink, so there is always room
+      std::span<std::byte> room()
+      {
+        if (segment_size_ == SegmentSize)
+        {
+          flush();
+        }
+        return { segment_.data() + segment_size_, SegmentSize - segment_size_ };
+      }
+
+      void commit(std::size_t n) noexcept
+      {
+        segment_size_ += n;
+      }
+
+      static constexpr decode_error overflow() noexcept
+      {
+        return decode_error::oversized; // Unreachable: frames have no size limit
+      }
+
+      std::optional<decode_error> end_frame(std::uint64_t size)
+      {
+        flush();
+        frame_size_ = size;
+        sink_->end_frame(std::expected<std::uint64_t, frame_error>{ size });
+        return std::nullopt;
+      }
+
+      // Drops the undelivered part of the segment and closes the frame with the error
+      void fail_frame(const frame_error &error)
+      {
+        segment_size_ = 0;
+        sink_->end_frame(std::expected<std::uint64_t, frame_error>{ std::unexpected(error) });
+      }
+
+      std::uint64_t frame_size() const noexcept
+      {
+        return frame_size_;
+      }
+    };
+
+    // Output of views::decode_into: decoded bytes go to the windows handed out by a Provider, which is
+    // only asked for one when a byte has to be written, so an empty frame never calls it
+    template <class Provider>
+    class provider_output
+    {
+      Provider *provider_ = nullptr;
+      std::span<std::byte> window_; // Current destination window
+      std::size_t window_pos_ = 0;
+      std::uint64_t frame_size_ = 0; // Bytes written to the current frame, then the size of the last frame
+
+    public:
+      provider_output() = default;
+      explicit provider_output(Provider *provider) noexcept
+          : provider_(provider)
+      {
+      }
+
+      void begin_frame() noexcept
+      {
+        window_ = {};
+        window_pos_ = 0;
+        frame_size_ = 0;
+      }
+
+      // Asks the provider for the next window once the current one is full
+      std::span<std::byte> room()
+      {
+        if (window_pos_ == window_.size())
+        {
+          window_ = (*provider_)(static_cast<std::size_t>(frame_size_));
+          window_pos_ = 0;
+        }
+        return window_.subspan(window_pos_);
+      }
+
+      void commit(std::size_t n) noexcept
+      {
+        window_pos_ += n;
+        frame_size_ += n;
+      }
+
+      static constexpr decode_error overflow() noexcept
+      {
+        return decode_error::oversized;
+      }
+
+      // Leaves a checksum trailer in the provider's memory but out of the frame size
+      std::optional<decode_error> end_frame(std::uint64_t size) noexcept
+      {
+        frame_size_ = size;
+        return std::nullopt;
+      }
+
+      void fail_frame(const frame_error &) noexcept
+      {
+      }
+
+      std::uint64_t frame_size() const noexcept
+      {
+        return frame_size_;
+      }
+    };
+
+    // Output of views::decode_as: a frame is decoded into storage of exactly sizeof(T) bytes, and a frame
+    // of any other length is a decode_error::size_mismatch
+    template <class T>
+    class object_output
+    {
+      std::array<std::byte, sizeof(T)> storage_;
+      std::size_t size_ = 0;
+
+    public:
+      constexpr void begin_frame() noexcept
+      {
+        size_ = 0;
+      }
+
+      constexpr std::span<std::byte> room() noexcept
+      {
+        return { storage_.data() + size_, sizeof(T) - size_ };
+      }
+
+      constexpr void commit(std::size_t n) noexcept
+      {
+        size_ += n;
+      }
+
+      static constexpr decode_error overflow() noexcept
+      {
+        return decode_error::size_mismatch;
+      }
+
+      constexpr std::optional<decode_error> end_frame(std::uint64_t size) noexcept
+      {
+        if (size != sizeof(T))
+        {
+          return decode_error::size_mismatch;
+        }
+        return std::nullopt;
+      }
+
+      constexpr void fail_frame(const frame_error &) noexcept
+      {
+      }
+
+      constexpr T value() const noexcept
+      {
+        return std::bit_cast<T>(storage_);
+      }
+    };
+
+    namespace views
+    {
+      // COBS Encoder: Range<Range<byte>> -> Range<byte>
+      // Encodes multiple frames into a single COBS stream; frames may also be gather lists of segments
+      template <std::ranges::input_range R,
+                cobs_variant Variant = cobs_variant::standard,
+                class Checksum = no_checksum,
+                class Observer = null_observer>
+        requires ByteRangeRange<R> || SegmentedFrameRange<R>
+      class encode : public std::ranges::view_interface<encode<R, Variant, Checksum, Observer>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        bool append_delim_;
+        std::byte delim_;
+
+      public:
+        encode() = default;
+        constexpr encode(R r, bool append_delim = true, std::byte delim = frame_delim)
+            : base_(std::views::all(std::move(r)))
+            , append_delim_(append_delim)
+            , delim_(delim)
+        {
+        }
+
+        encode(const encode &) = delete;
+        encode &operator=(const encode &) = delete;
+        encode(encode &&) = default;
+        encode &operator=(encode &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          using Frame = std::ranges::range_value_t<Base>;
+          using Segment = typename segment_of<Frame>::type;
+          static constexpr bool segmented = ByteRangeRange<Frame>;
+
+          // For gather lists these walk the current segment; COBS block state carries across segments
+          using FrameIter = std::ranges::iterator_t<Segment>;
+          using FrameSent = std::ranges::sentinel_t<Segment>;
+
+          using SegmentIter = std::conditional_t<segmented, std::ranges::iterator_t<Frame>, no_segments>;
+          using SegmentSent = std::conditional_t<segmented, std::ranges::sentinel_t<Frame>, no_segments>;
+
+          BaseIter frames_it_;
+          BaseSent frames_end_;
+          bool append_delim_;
+          std::byte delim_; // Every output byte is XOR-ed with the delimiter
+
+          FrameIter current_frame_it_{};
+          FrameSent current_frame_end_{};
+          [[no_unique_address]] SegmentIter segments_it_{};
+          [[no_unique_address]] SegmentSent segments_end_{};
+
+          std::array<std::byte, 255> unit_buffer_;
+          std::size_t unit_size_ = 0;
+          std::size_t unit_pos_ = 0;
+
+          // Checksum of the frame payload, encoded as trailing payload bytes
+          [[no_unique_address]] Checksum checksum_;
+          std::array<std::byte, Checksum::digest_size> trailer_;
+          std::size_t trailer_pos_ = 0;
+          bool trailer_ready_ = false;
+
+          // Per-frame byte accounting, only maintained for a real observer
+          static constexpr bool observed = !std::same_as<Observer, null_observer>;
+          [[no_unique_address]] Observer observer_;
+          std::size_t payload_size_ = 0;
+          std::size_t encoded_size_ = 0;
+
+          enum class encode_state
+          {
+            start_of_frame,
+            start_of_chunk,
+            on_byte,
+            end_of_chunk,
+            end_of_last_chunk,
+            end_of_frame,
+            finished,
+          };
+          encode_state state_ = encode_state::start_of_frame;
+
+          constexpr bool can_start_next_frame()
+          {
+            return frames_it_ != frames_end_;
+          }
+
+          // Moves to the next non-empty segment of a gather list; false once the frame is exhausted
+          constexpr bool next_segment()
+          {
+            if constexpr (segmented)
+            {
+              while (segments_it_ != segments_end_)
+              {
+                auto &&segment = *segments_it_;
+                current_frame_it_ = std::ranges::begin(segment);
+                current_frame_end_ = std::ranges::end(segment);
+                ++segments_it_;
+                if (current_frame_it_ != current_frame_end_)
+                {
+                  return true;
+                }
+              }
+            }
+            return false;
+          }
+
+          constexpr void setup_next_frame()
+          {
+            auto &&frame = *frames_it_;
+            if constexpr (segmented)
+            {
+              segments_it_ = std::ranges::begin(frame);
+              segments_end_ = std::ranges::end(frame);
+              current_frame_it_ = FrameIter{};
+              current_frame_end_ = FrameSent{};
+              next_segment();
+            }
+            else
+            {
+              current_frame_it_ = std::ranges::begin(frame);
+              current_frame_end_ = std::ranges::end(frame);
+            }
+            ++frames_it_;
+            checksum_ = Checksum{};
+            trailer_pos_ = 0;
+            trailer_ready_ = false;
+            payload_size_ = 0;
+            encoded_size_ = 0;
+          }
+
+          constexpr encode_state process_start_of_frame()
+          {
+            if (!can_start_next_frame())
+            {
+              return encode_state::finished;
+            }
+
+            setup_next_frame();
+            return encode_state::start_of_chunk;
+          }
+
+          constexpr encode_state process_start_of_chunk()
+          {
+            unit_size_ = 1;
+            return encode_state::on_byte;
+          }
+
+          // Contiguous fast path: copy the non-zero run up to the next zero in one go
+          constexpr void scan_run()
+          {
+            if consteval
+            {
+              return; // Fast paths need raw pointers and the vector kernels
+            }
+            if constexpr (ContiguousBytes<FrameIter, FrameSent>)
+            {
+              const std::byte *first = as_bytes_ptr(current_frame_it_);
+              std::size_t avail = std::min(
+                  255 - unit_size_,
+                  static_cast<std::size_t>(current_frame_end_ - current_frame_it_)
+              );
+              std::size_t run = static_cast<std::size_t>(
+                  kernels::find_byte(first, first + avail, std::byte{ 0 }) - first
+              );
+              checksum_.update(first, run);
+              if constexpr (observed)
+              {
+                payload_size_ += run;
+              }
+              kernels::copy_xor(unit_buffer_.data() + unit_size_, first, run, delim_);
+              unit_size_ += run;
+              current_frame_it_ += static_cast<std::iter_difference_t<FrameIter>>(run);
+            }
+          }
+
+          constexpr encode_state push_byte(std::byte b)
+          {
+            if (b == std::byte{ 0 })
+            {
+              return encode_state::end_of_chunk;
+            }
+
+            unit_buffer_[unit_size_] = b ^ delim_;
+            ++unit_size_;
+
+            return encode_state::on_byte;
+          }
+
+          // Feeds the checksum digest through the encoder once the payload is exhausted
+          constexpr encode_state process_trailer()
+          {
+            if constexpr (Checksum::digest_size == 0)
+            {
+              return encode_state::end_of_last_chunk;
+            }
+            else
+            {
+              if (!trailer_ready_)
+              {
+                trailer_ = checksum_.digest();
+                trailer_ready_ = true;
+              }
+
+              if (trailer_pos_ == Checksum::digest_size)
+              {
+                return encode_state::end_of_last_chunk;
+              }
+
+              if (255 <= unit_size_)
+              {
+                return encode_state::end_of_chunk;
+              }
+
+              return push_byte(trailer_[trailer_pos_++]);
+            }
+          }
+
+          constexpr encode_state process_on_byte()
+          {
+            scan_run();
+
+            if (current_frame_it_ == current_frame_end_)
+            {
+              if (next_segment())
+              {
+                return encode_state::on_byte;
+              }
+              return process_trailer();
+            }
+
+            if (255 <= unit_size_)
+            {
+              return encode_state::end_of_chunk;
+            }
+
+            std::byte b = to_byte(*current_frame_it_);
+            ++current_frame_it_;
+            checksum_.update(&b, 1);
+            if constexpr (observed)
+            {
+              ++payload_size_;
+            }
+            return push_byte(b);
+          }
+
+          constexpr encode_state process_end_of_chunk()
+          {
+            unit_buffer_[0] = static_cast<std::byte>(unit_size_) ^ delim_;
+            if constexpr (observed)
+            {
+              encoded_size_ += unit_size_;
+            }
+            return encode_state::start_of_chunk;
+          }
+
+          constexpr encode_state process_end_of_last_chunk()
+          {
+            unit_buffer_[0] = static_cast<std::byte>(unit_size_) ^ delim_;
+            if constexpr (Variant == cobs_variant::reduced)
+            {
+              // COBS/R: fold the last data byte into the code when it is not smaller than the code
+              if (1 < unit_size_ &&
+                  unit_size_ <= static_cast<std::size_t>(unit_buffer_[unit_size_ - 1] ^ delim_))
+              {
+                unit_buffer_[0] = unit_buffer_[unit_size_ - 1];
+                --unit_size_;
+              }
+            }
+            if constexpr (observed)
+            {
+              encoded_size_ += unit_size_;
+            }
+            return encode_state::end_of_frame;
+          }
+
+          constexpr encode_state process_end_of_frame()
+          {
+            if (append_delim_ || can_start_next_frame())
+            {
+              unit_buffer_[0] = delim_;
+              unit_size_ = 1;
+              observer_.on_frame_encoded(payload_size_, encoded_size_ + 1);
+              return encode_state::start_of_frame;
+            }
+
+            observer_.on_frame_encoded(payload_size_, encoded_size_);
+            unit_size_ = 0;
+            return encode_state::finished;
+          }
+
+          constexpr bool build_next_unit()
+          {
+            unit_pos_ = 0; // unit_size_ は状態関数で管理
+
+            while (true)
+            {
+              switch (state_)
+              {
+              case encode_state::start_of_frame:
+                state_ = process_start_of_frame();
+                break;
+              case encode_state::start_of_chunk:
+                state_ = process_start_of_chunk();
+                break;
+              case encode_state::on_byte:
+                state_ = process_on_byte();
+                break;
+              case encode_state::end_of_chunk:
+                state_ = process_end_of_chunk();
+                return true;
+              case encode_state::end_of_last_chunk:
+                state_ = process_end_of_last_chunk();
+                return true;
+              case encode_state::end_of_frame:
+                state_ = process_end_of_frame();
+                return true;
+              case encode_state::finished:
+                unit_size_ = 0;
+                return false;
+              }
+            }
+          }
+
+        public:
+          using value_type = std::byte;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          constexpr iterator(BaseIter it, BaseSent end, bool append_delim, std::byte delim)
+              : frames_it_(it)
+              , frames_end_(end)
+              , append_delim_(append_delim)
+              , delim_(delim)
+          {
+            build_next_unit();
+          }
+
+          constexpr std::byte operator*() const
+          {
+            return unit_buffer_[unit_pos_];
+          }
+
+          constexpr iterator &operator++()
+          {
+            ++unit_pos_;
+
+            if (unit_pos_ >= unit_size_)
+            {
+              build_next_unit();
+            }
+
+            return *this;
+          }
+
+          constexpr void operator++(int)
+          {
+            ++*this;
+          }
+
+          friend constexpr bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.state_ == encode_state::finished && it.unit_pos_ >= it.unit_size_;
+          }
+        };
+
+        constexpr iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), append_delim_, delim_ };
+        }
+
+        constexpr std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // Fixed-size COBS Encoder: Range<Frame> -> Range<byte>, sizeof-known frames only
+      // Each frame is encoded run by run in one call into a buffer sized for the worst case at compile
+      // time, then handed out byte by byte; there is no per-byte state dispatch.
+      template <std::ranges::input_range R>
+        requires FixedSizeFrameRange<R>
+      class encode_fixed : public std::ranges::view_interface<encode_fixed<R>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        bool append_delim_;
+        std::byte delim_;
+
+      public:
+        encode_fixed() = default;
+        constexpr encode_fixed(R r, bool append_delim = true, std::byte delim = frame_delim)
+            : base_(std::views::all(std::move(r)))
+            , append_delim_(append_delim)
+            , delim_(delim)
+        {
+        }
+
+        encode_fixed(const encode_fixed &) = delete;
+        encode_fixed &operator=(const encode_fixed &) = delete;
+        encode_fixed(encode_fixed &&) = default;
+        encode_fixed &operator=(encode_fixed &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          using Frame = std::remove_cv_t<std::ranges::range_value_t<Base>>;
+          static constexpr std::size_t frame_size = fixed_frame_size<Frame>::value;
+
+          // One code byte per started 254-byte run, plus the delimiter
+          static constexpr std::size_t max_encoded_size = frame_size + frame_size / 254 + 2;
+
+          BaseIter frames_it_;
+          BaseSent frames_end_;
+          bool append_delim_;
+          std::byte delim_;
+
+          std::array<std::byte, max_encoded_size> out_;
+          std::size_t out_size_ = 0;
+          std::size_t out_pos_ = 0;
+
+          // Same block layout as views::encode: a full 254-byte run only closes a block when more
+          // payload follows, so no trailing 0x01 block is emitted
+          constexpr std::size_t encode_frame(const std::byte *src)
+          {
+            std::size_t code_pos = 0;
+            std::size_t pos = 1;
+            std::size_t i = 0;
+            while (true)
+            {
+              std::size_t avail = std::min<std::size_t>(254, frame_size - i);
+              std::size_t run = static_cast<std::size_t>(
+                  kernels::find_byte(src + i, src + i + avail, std::byte{ 0 }) - (src + i)
+              );
+              kernels::copy_xor(out_.data() + pos, src + i, run, delim_);
+              pos += run;
+              i += run;
+              out_[code_pos] = static_cast<std::byte>(run + 1) ^ delim_;
+              if (i == frame_size)
+              {
+                return pos;
+              }
+              // Either a zero ends the block, or a full block continues with the next byte
+              i += run < 254 ? 1 : 0;
+              code_pos = pos++;
+            }
+          }
+
+          constexpr void build_next_frame()
+          {
+            out_pos_ = 0;
+            if (frames_it_ == frames_end_)
+            {
+              out_size_ = 0;
+              return;
+            }
+
+            {
+              auto &&frame = *frames_it_;
+              if consteval
+              {
+                out_size_ = encode_frame(constant_frame_bytes(frame).data());
+              }
+              else
+              {
+                out_size_ = encode_frame(frame_bytes(frame));
+              }
+            }
+            ++frames_it_;
+            if (append_delim_ || frames_it_ != frames_end_)
+            {
+              out_[out_size_++] = delim_;
+            }
+          }
+
+        public:
+          using value_type = std::byte;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          constexpr iterator(BaseIter it, BaseSent end, bool append_delim, std::byte delim)
+              : frames_it_(it)
+              , frames_end_(end)
+              , append_delim_(append_delim)
+              , delim_(delim)
+          {
+            build_next_frame();
+          }
+
+          constexpr std::byte operator*() const
+          {
+            return out_[out_pos_];
+          }
+
+          constexpr iterator &operator++()
+          {
+            if (++out_pos_ == out_size_)
+            {
+              build_next_frame();
+            }
+            return *this;
+          }
+
+          constexpr void operator++(int)
+          {
+            ++*this;
+          }
+
+          friend constexpr bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.out_size_ == 0;
+          }
+        };
+
+        constexpr iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), append_delim_, delim_ };
+        }
+
+        constexpr std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // COBS Decoder: Range<byte> -> Range<expected<span<byte>, error>>
+      // Decodes a COBS stream into multiple frames with error handling
+      template <std::size_t MaxFrameSize,
+                std::ranges::input_range R,
+                cobs_variant Variant = cobs_variant::standard,
+                class Checksum = no_checksum,
+                class Observer = null_observer,
+                class Loop = state_machine_loop>
+        requires ByteLike<std::ranges::range_value_t<R>>
+      class decode
+          : public std::ranges::view_interface<decode<MaxFrameSize, R, Variant, Checksum, Observer, Loop>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        std::byte delim_;
+
+      public:
+        static constexpr std::size_t max_frame_size = MaxFrameSize;
+
+        decode() = default;
+        constexpr explicit decode(R r, std::byte delim = frame_delim)
+            : base_(std::views::all(std::move(r)))
+            , delim_(delim)
+        {
+        }
+
+        decode(const decode &) = delete;
+        decode &operator=(const decode &) = delete;
+        decode(decode &&) = default;
+        decode &operator=(decode &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          static constexpr bool whole_frame_loop =
+              Variant == cobs_variant::standard && !std::same_as<Loop, state_machine_loop>;
+
+          block_parser<BaseIter, BaseSent, Variant, Checksum, Observer> parser_;
+          buffer_output<MaxFrameSize, loop_slack<Loop>> output_;
+          step_status status_ = step_status::finished;
+
+        public:
+          using frame_type = std::span<const std::byte>;
+          using value_type = std::expected<frame_type, frame_error>;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          constexpr iterator(BaseIter it, BaseSent end, std::byte delim)
+              : parser_(std::move(it), std::move(end), delim)
+          {
+            if constexpr (ContiguousBytes<BaseIter, BaseSent> && 64 <= MaxFrameSize && !whole_frame_loop)
+            {
+              if !consteval
+              {
+                parser_.use_block_kernel(kernels::active_kernels().decode_blocks);
+              }
+            }
+            status_ = parser_.template next<Loop>(output_);
+          }
+
+          constexpr value_type operator*() const
+          {
+            if (status_ == step_status::error)
+            {
+              return std::unexpected(parser_.error());
+            }
+            return output_.frame();
+          }
+
+          constexpr iterator &operator++()
+          {
+            // The parser skips the rest of a failed frame before it decodes the next one
+            if (status_ != step_status::finished)
+            {
+              status_ = parser_.template next<Loop>(output_);
+            }
+            return *this;
+          }
+
+          constexpr void operator++(int)
+          {
+            ++*this;
+          }
+
+          // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+          // counted, when the iterator moves past its error
+          constexpr std::uint64_t resync_bytes() const noexcept
+          {
+            return parser_.resync_bytes();
+          }
+
+          friend constexpr bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.status_ == step_status::finished;
+          }
+        };
+
+        constexpr iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), delim_ };
+        }
+
+        constexpr std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // Scatter COBS Decoder: Range<byte> -> Range<expected<size_t, frame_error>>
+      // Decoded bytes go straight to the spans handed out by a destination provider; each element
+      // reports the size of a frame written there. Provider: std::span<std::byte>(std::size_t offset),
+      // asked for more space at the given frame offset when a byte has to be written; offset 0 starts a
+      // new frame, so an empty frame never calls it, and an empty span ends the frame as
+      // decode_error::oversized. A Checksum trailer is written after the payload, so the provider must
+      // have room for it, but it is not counted in the frame size.
+      template <std::ranges::input_range R,
+                class Provider,
+                class Checksum = no_checksum,
+                class Observer = null_observer>
+        requires ByteLike<std::ranges::range_value_t<R>> &&
+                 std::is_invocable_r_v<std::span<std::byte>, Provider &, std::size_t>
+      class decode_into : public std::ranges::view_interface<decode_into<R, Provider, Checksum, Observer>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        Provider provider_;
+        std::byte delim_;
+
+      public:
+        decode_into() = default;
+        decode_into(R r, Provider provider, std::byte delim = frame_delim)
+            : base_(std::views::all(std::move(r)))
+            , provider_(std::move(provider))
+            , delim_(delim)
+        {
+        }
+
+        decode_into(const decode_into &) = delete;
+        decode_into &operator=(const decode_into &) = delete;
+        decode_into(decode_into &&) = default;
+        decode_into &operator=(decode_into &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          block_parser<BaseIter, BaseSent, cobs_variant::standard, Checksum, Observer> parser_;
+          provider_output<Provider> output_;
+          step_status status_ = step_status::finished;
+
+        public:
+          using value_type = std::expected<std::size_t, frame_error>;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          iterator(BaseIter it, BaseSent end, Provider *provider, std::byte delim)
+              : parser_(std::move(it), std::move(end), delim)
+              , output_(provider)
+          {
+            status_ = parser_.next(output_);
+          }
+
+          value_type operator*() const
+          {
+            if (status_ == step_status::error)
+            {
+              return std::unexpected(parser_.error());
+            }
+            return static_cast<std::size_t>(output_.frame_size());
+          }
+
+          iterator &operator++()
+          {
+            if (status_ != step_status::finished)
+            {
+              status_ = parser_.next(output_);
+            }
+            return *this;
+          }
+
+          void operator++(int)
+          {
+            ++*this;
+          }
+
+          // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+          // counted, when the iterator moves past its error
+          std::uint64_t resync_bytes() const noexcept
+          {
+            return parser_.resync_bytes();
+          }
+
+          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.status_ == step_status::finished;
+          }
+        };
+
+        iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), &provider_, delim_ };
+        }
+
+        std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // Segmented COBS Decoder: Range<byte> -> Range<expected<uint64_t, frame_error>>
+      // Streams each frame to a FrameSink in segments of at most SegmentSize bytes, so memory stays
+      // constant whatever the frame size. Every element is also passed to the sink's end_frame(),
+      // which pairs with one begin_frame(); segments of a failed frame already delivered stay delivered.
+      // Frames have no size limit, and input that ends inside a frame is always decode_error::incomplete.
+      template <std::size_t SegmentSize, std::ranges::input_range R, FrameSink Sink>
+        requires ByteLike<std::ranges::range_value_t<R>> && (0 < SegmentSize)
+      class decode_segmented : public std::ranges::view_interface<decode_segmented<SegmentSize, R, Sink>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        Sink *sink_ = nullptr;
+        std::byte delim_;
+
+      public:
+        decode_segmented() = default;
+        decode_segmented(R r, Sink &sink, std::byte delim = frame_delim)
+            : base_(std::views::all(std::move(r)))
+            , sink_(&sink)
+            , delim_(delim)
+        {
+        }
+
+        decode_segmented(const decode_segmented &) = delete;
+        decode_segmented &operator=(const decode_segmented &) = delete;
+        decode_segmented(decode_segmented &&) = default;
+        decode_segmented &operator=(decode_segmented &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          block_parser<BaseIter, BaseSent> parser_;
+          segment_output<SegmentSize, Sink> output_;
+          step_status status_ = step_status::finished;
+
+        public:
+          using value_type = std::expected<std::uint64_t, frame_error>;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          iterator(BaseIter it, BaseSent end, Sink *sink, std::byte delim)
+              : parser_(std::move(it), std::move(end), delim)
+              , output_(sink)
+          {
+            status_ = parser_.next(output_);
+          }
+
+          value_type operator*() const
+          {
+            if (status_ == step_status::error)
+            {
+              return std::unexpected(parser_.error());
+            }
+            return output_.frame_size();
+          }
+
+          iterator &operator++()
+          {
+            if (status_ != step_status::finished)
+            {
+              status_ = parser_.next(output_);
+            }
+            return *this;
+          }
+
+          void operator++(int)
+          {
+            ++*this;
+          }
+
+          // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+          // counted, when the iterator moves past its error
+          std::uint64_t resync_bytes() const noexcept
+          {
+            return parser_.resync_bytes();
+          }
+
+          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.status_ == step_status::finished;
+          }
+        };
+
+        iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), sink_, delim_ };
+        }
+
+        std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // Typed COBS Decoder: Range<byte> -> Range<expected<T, frame_error>>
+      // Frames are decoded into a buffer of exactly sizeof(T) bytes and yielded as T values; a frame of
+      // any other length is reported as decode_error::size_mismatch.
+      template <std::ranges::input_range R, class T>
+        requires ByteLike<std::ranges::range_value_t<R>> && std::is_trivially_copyable_v<T>
+      class decode_as : public std::ranges::view_interface<decode_as<R, T>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        std::byte delim_;
+
+      public:
+        decode_as() = default;
+        explicit decode_as(R r, std::byte delim = frame_delim)
+            : base_(std::views::all(std::move(r)))
+            , delim_(delim)
+        {
+        }
+
+        decode_as(const decode_as &) = delete;
+        decode_as &operator=(const decode_as &) = delete;
+        decode_as(decode_as &&) = default;
+        decode_as &operator=(decode_as &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          block_parser<BaseIter, BaseSent> parser_;
+          object_output<T> output_;
+          step_status status_ = step_status::finished;
+
+        public:
+          using value_type = std::expected<T, frame_error>;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          iterator(BaseIter it, BaseSent end, std::byte delim)
+              : parser_(std::move(it), std::move(end), delim)
+          {
+            status_ = parser_.next(output_);
+          }
+
+          value_type operator*() const
+          {
+            if (status_ == step_status::error)
+            {
+              return std::unexpected(parser_.error());
+            }
+            return output_.value();
+          }
+
+          iterator &operator++()
+          {
+            if (status_ != step_status::finished)
+            {
+              status_ = parser_.next(output_);
+            }
+            return *this;
+          }
+
+          void operator++(int)
+          {
+            ++*this;
+          }
+
+          // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+          // counted, when the iterator moves past its error
+          std::uint64_t resync_bytes() const noexcept
+          {
+            return parser_.resync_bytes();
+          }
+
+          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.status_ == step_status::finished;
+          }
+        };
+
+        iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), delim_ };
+        }
+
+        std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // COBS/ZPE Encoder: Range<Range<byte>> -> Range<byte>
+      // Zero-pair elimination: a run followed by two zeros is folded into a single code byte
+      template <std::ranges::input_range R>
+        requires ByteRangeRange<R>
+      class encode_zpe : public std::ranges::view_interface<encode_zpe<R>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+        bool append_delim_;
+
+      public:
+        encode_zpe() = default;
+        encode_zpe(R r, bool append_delim = true)
+            : base_(std::views::all(std::move(r)))
+            , append_delim_(append_delim)
+        {
+        }
+
+        encode_zpe(const encode_zpe &) = delete;
+        encode_zpe &operator=(const encode_zpe &) = delete;
+        encode_zpe(encode_zpe &&) = default;
+        encode_zpe &operator=(encode_zpe &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+          using FrameIter = std::ranges::iterator_t<std::ranges::range_value_t<Base>>;
+          using FrameSent = std::ranges::sentinel_t<std::ranges::range_value_t<Base>>;
+
+          BaseIter frames_it_;
+          BaseSent frames_end_;
+          bool append_delim_;
+
+          FrameIter current_frame_it_;
+          FrameSent current_frame_end_;
+
+          std::array<std::byte, zpe::max_run + 1> unit_buffer_;
+          std::size_t unit_size_ = 0;
+          std::size_t unit_pos_ = 0;
+          std::optional<std::byte> carry_; // Non-zero byte read ahead while looking for a zero pair
+          enum class encode_state
+          {
+            start_of_frame,
+            on_block,
+            end_of_frame,
+            finished,
+          };
+          encode_state state_ = encode_state::start_of_frame;
+
+          bool can_start_next_frame()
+          {
+            return frames_it_ != frames_end_;
+          }
+
+          void setup_next_frame()
+          {
+            auto &&frame = *frames_it_;
+            current_frame_it_ = std::ranges::begin(frame);
+            current_frame_end_ = std::ranges::end(frame);
+            carry_.reset();
+            ++frames_it_;
+          }
+
+          bool frame_exhausted()
+          {
+            return !carry_ && current_frame_it_ == current_frame_end_;
+          }
+
+          std::optional<std::byte> next_byte()
+          {
+            if (carry_)
+            {
+              std::byte b = *carry_;
+              carry_.reset();
+              return b;
+            }
+            if (current_frame_it_ == current_frame_end_)
+            {
+              return std::nullopt;
+            }
+            std::byte b = to_byte(*current_frame_it_);
+            ++current_frame_it_;
+            return b;
+          }
+
+          // Contiguous fast path: copy the non-zero run up to the next zero in one go
+          void scan_run()
+          {
+            if constexpr (ContiguousBytes<FrameIter, FrameSent>)
+            {
+              if (carry_)
+              {
+                return;
+              }
+              const std::byte *first = as_bytes_ptr(current_frame_it_);
+              std::size_t avail = std::min(
+                  zpe::max_run + 1 - unit_size_,
+                  static_cast<std::size_t>(current_frame_end_ - current_frame_it_)
+              );
+              std::size_t run = static_cast<std::size_t>(
+                  kernels::find_byte(first, first + avail, std::byte{ 0 }) - first
+              );
+              std::memcpy(unit_buffer_.data() + unit_size_, first, run);
+              unit_size_ += run;
+              current_frame_it_ += static_cast<std::iter_difference_t<FrameIter>>(run);
+            }
+          }
+
+          encode_state process_start_of_frame()
+          {
+            if (!can_start_next_frame())
+            {
+              return encode_state::finished;
+            }
+
+            setup_next_frame();
+            return encode_state::on_block;
+          }
+
+          encode_state process_on_block()
+          {
+            unit_size_ = 1;
+            while (true)
+            {
+              scan_run();
+
+              std::size_t run = unit_size_ - 1;
+              if (zpe::max_run <= run)
+              {
+                unit_buffer_[0] = static_cast<std::byte>(zpe::run_code);
+                return frame_exhausted() ? encode_state::end_of_frame : encode_state::on_block;
+              }
+
+              std::optional<std::byte> b = next_byte();
+              if (!b)
+              {
+                // The implicit trailing zero closes the last block
+                unit_buffer_[0] = static_cast<std::byte>(unit_size_);
+                return encode_state::end_of_frame;
+              }
+
+              if (*b != std::byte{ 0 })
+              {
+                unit_buffer_[unit_size_] = *b;
+                ++unit_size_;
+                continue;
+              }
+
+              if (run <= zpe::max_pair_run)
+              {
+                std::optional<std::byte> after = next_byte();
+                if (!after || *after == std::byte{ 0 })
+                {
+                  unit_buffer_[0] = static_cast<std::byte>(zpe::pair_code + run);
+                  return after ? encode_state::on_block : encode_state::end_of_frame;
+                }
+                carry_ = after;
+              }
+
+              unit_buffer_[0] = static_cast<std::byte>(unit_size_);
+              return encode_state::on_block;
+            }
+          }
+
+          encode_state process_end_of_frame()
+          {
+            if (append_delim_ || can_start_next_frame())
+            {
+              unit_buffer_[0] = frame_delim;
+              unit_size_ = 1;
+              return encode_state::start_of_frame;
+            }
+
+            unit_size_ = 0;
+            return encode_state::finished;
+          }
+
+          bool build_next_unit()
+          {
+            unit_pos_ = 0;
+
+            while (true)
+            {
+              switch (state_)
+              {
+              case encode_state::start_of_frame:
+                state_ = process_start_of_frame();
+                break;
+              case encode_state::on_block:
+                state_ = process_on_block();
+                return true;
+              case encode_state::end_of_frame:
+                state_ = process_end_of_frame();
+                if (unit_size_ != 0)
+                {
+                  return true;
+                }
+                break;
+              case encode_state::finished:
+                unit_size_ = 0;
+                return false;
+              }
+            }
+          }
+
+        public:
+          using value_type = std::byte;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          iterator(BaseIter it, BaseSent end, bool append_delim)
+              : frames_it_(it)
+              , frames_end_(end)
+              , append_delim_(append_delim)
+          {
+            build_next_unit();
+          }
+
+          std::byte operator*() const
+          {
+            return unit_buffer_[unit_pos_];
+          }
+
+          iterator &operator++()
+          {
+            ++unit_pos_;
+
+            if (unit_pos_ >= unit_size_)
+            {
+              build_next_unit();
+            }
+
+            return *this;
+          }
+
+          void operator++(int)
+          {
+            ++*this;
+          }
+
+          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.state_ == encode_state::finished && it.unit_pos_ >= it.unit_size_;
+          }
+        };
+
+        iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), append_delim_ };
+        }
+
+        std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // COBS/ZPE Decoder: Range<byte> -> Range<expected<span<byte>, frame_error>>
+      template <std::size_t MaxFrameSize, std::ranges::input_range R>
+        requires ByteLike<std::ranges::range_value_t<R>>
+      class decode_zpe : public std::ranges::view_interface<decode_zpe<MaxFrameSize, R>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+
+      public:
+        static constexpr std::size_t max_frame_size = MaxFrameSize;
+
+        decode_zpe() = default;
+        explicit decode_zpe(R r)
+            : base_(std::views::all(std::move(r)))
+        {
+        }
+
+        decode_zpe(const decode_zpe &) = delete;
+        decode_zpe &operator=(const decode_zpe &) = delete;
+        decode_zpe(decode_zpe &&) = default;
+        decode_zpe &operator=(decode_zpe &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          BaseIter it_;
+          BaseSent end_;
+
+          std::array<std::byte, MaxFrameSize> frame_buffer_;
+          std::size_t frame_size_ = 0;
+
+          std::optional<decode_error> current_error_;
+          bool resync_ = false; // Error raised before the frame's delimiter was consumed
+          bool finished_ = false;
+
+          std::uint64_t offset_ = 0;
+          std::uint64_t frame_start_ = 0;
+          std::uint64_t frame_index_ = 0;
+          std::uint64_t resync_bytes_ = 0; // Input skipped while resynchronising, delimiters included
+          frame_error failure_{ decode_error::incomplete };
+
+          enum class decode_state
+          {
+            wait_for_code,
+            read_data_bytes,
+            handle_zero,
+            frame_complete,
+            error_state,
+            finished
+          };
+          decode_state state_ = decode_state::wait_for_code;
+
+          std::size_t block_size_ = 0;
+          std::size_t zeros_ = 0;
+          std::size_t bytes_read_ = 0;
+
+          void skip_to_delimiter()
+          {
+            std::uint64_t start = offset_;
+            if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+            {
+              const std::byte *first = as_bytes_ptr(it_);
+              auto n = kernels::find_byte(first, first + (end_ - it_), frame_delim) - first;
+              it_ += n;
+              offset_ += static_cast<std::uint64_t>(n);
+            }
+
+            while (it_ != end_)
+            {
+              ++offset_;
+              if (to_byte(*it_) == frame_delim)
+              {
+                ++it_;
+                break;
+              }
+              ++it_;
+            }
+            resync_bytes_ += offset_ - start;
+          }
+
+          // Reports the frame where it failed; a delimiter that failed it is consumed with it, otherwise
+          // the rest of the frame is skipped on the next ++
+          void fail_frame()
+          {
+            std::uint64_t at = offset_;
+            resync_ = it_ != end_;
+            if (resync_ && to_byte(*it_) == frame_delim)
+            {
+              ++it_;
+              ++offset_;
+              ++resync_bytes_;
+              resync_ = false;
+            }
+            failure_ = frame_error{ *current_error_, at, frame_index_, offset_ - frame_start_ };
+          }
+
+          decode_state process_wait_for_code()
+          {
+            if (it_ == end_)
+            {
+              return decode_state::finished;
+            }
+
+            std::byte code_byte = to_byte(*it_);
+            ++it_;
+            ++offset_;
+
+            if (code_byte == frame_delim)
+            {
+              return decode_state::frame_complete;
+            }
+
+            std::size_t code = static_cast<std::size_t>(code_byte);
+            if (code < zpe::run_code)
+            {
+              block_size_ = code - 1;
+              zeros_ = 1;
+            }
+            else if (code == zpe::run_code)
+            {
+              block_size_ = zpe::max_run;
+              zeros_ = 0;
+            }
+            else
+            {
+              block_size_ = code - zpe::pair_code;
+              zeros_ = 2;
+            }
+
+            bytes_read_ = 0;
+            return decode_state::read_data_bytes;
+          }
+
+          // Contiguous fast path: copy the rest of the block in one go
+          void copy_block()
+          {
+            if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+            {
+              const std::byte *first = as_bytes_ptr(it_);
+              std::size_t avail = std::min(
+                  { block_size_ - bytes_read_,
+                    MaxFrameSize - frame_size_,
+                    static_cast<std::size_t>(end_ - it_) }
+              );
+              std::size_t n =
+                  static_cast<std::size_t>(kernels::find_byte(first, first + avail, frame_delim) - first);
+              std::memcpy(frame_buffer_.data() + frame_size_, first, n);
+              frame_size_ += n;
+              bytes_read_ += n;
+              it_ += static_cast<std::iter_difference_t<BaseIter>>(n);
+              offset_ += n;
+            }
+          }
+
+          decode_state process_read_data_bytes()
+          {
+            copy_block();
+
+            while (bytes_read_ < block_size_ && it_ != end_)
+            {
+              if (MaxFrameSize <= frame_size_)
+              {
+                current_error_ = decode_error::oversized;
+                return decode_state::error_state;
+              }
+
+              std::byte b = to_byte(*it_);
+              if (b == frame_delim)
+              {
+                current_error_ = decode_error::invalid_cobs;
+                return decode_state::error_state;
+              }
+
+              frame_buffer_[frame_size_] = b;
+              ++frame_size_;
+              ++it_;
+              ++offset_;
+              ++bytes_read_;
+            }
+
+            if (bytes_read_ == block_size_)
+            {
+              return decode_state::handle_zero;
+            }
+
+            current_error_ = decode_error::incomplete;
+            return decode_state::error_state;
+          }
+
+          decode_state append_zeros(std::size_t count, decode_state next)
+          {
+            if (MaxFrameSize - frame_size_ < count)
+            {
+              current_error_ = decode_error::oversized;
+              return decode_state::error_state;
+            }
+            std::fill_n(frame_buffer_.data() + frame_size_, count, std::byte{ 0 });
+            frame_size_ += count;
+            return next;
+          }
+
+          decode_state process_handle_zero()
+          {
+            if (zeros_ == 0)
+            {
+              return decode_state::wait_for_code;
+            }
+
+            if (it_ == end_)
+            {
+              current_error_ = decode_error::incomplete;
+              return decode_state::error_state;
+            }
+
+            if (to_byte(*it_) == frame_delim)
+            {
+              // The last zero of the frame is the implicit one added by the encoder
+              ++it_;
+              ++offset_;
+              return append_zeros(zeros_ - 1, decode_state::frame_complete);
+            }
+
+            return append_zeros(zeros_, decode_state::wait_for_code);
+          }
+
+          bool decode_next_frame()
+          {
+            frame_size_ = 0;
+            current_error_.reset();
+            state_ = decode_state::wait_for_code;
+            frame_start_ = offset_;
+
+            while (true)
+            {
+              switch (state_)
+              {
+              case decode_state::wait_for_code:
+                state_ = process_wait_for_code();
+                break;
+
+              case decode_state::read_data_bytes:
+                state_ = process_read_data_bytes();
+                break;
+
+              case decode_state::handle_zero:
+                state_ = process_handle_zero();
+                break;
+
+              case decode_state::frame_complete:
+                state_ = decode_state::wait_for_code;
+                return true;
+
+              case decode_state::error_state:
+                fail_frame();
+                return false;
+
+              case decode_state::finished:
+                finished_ = true;
+                return false;
+              }
+            }
+          }
+
+        public:
+          using frame_type = std::span<const std::byte>;
+          using value_type = std::expected<frame_type, frame_error>;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          iterator(BaseIter it, BaseSent end)
+              : it_(it)
+              , end_(end)
+          {
+            finished_ = !decode_next_frame() && !current_error_;
+          }
+
+          value_type operator*() const
+          {
+            if (current_error_)
+            {
+              return std::unexpected(failure_);
+            }
+            return frame_type{ frame_buffer_.data(), frame_size_ };
+          }
+
+          iterator &operator++()
+          {
+            if (resync_)
+            {
+              skip_to_delimiter();
+              resync_ = false;
+            }
 
-  template <class T>
-  concept ByteRangeRange = std::ranges::input_range<T> && ByteRange<std::ranges::range_value_t<T>>;
+            if (!finished_)
+            {
+              ++frame_index_;
+              finished_ = !decode_next_frame() && !current_error_;
+            }
 
-  inline constexpr std::byte frame_delim{ 0x00 };
+            return *this;
+          }
 
-  namespace
-  {
-    template <class T>
-    [[nodiscard]] constexpr std::byte to_byte(T v) noexcept
-    {
-      if constexpr (std::same_as<std::remove_cvref_t<T>, std::byte>)
-      {
-        return v;
-      }
-      else
-      {
-        return static_cast<std::byte>(static_cast<unsigned char>(v));
-      }
-    }
+          void operator++(int)
+          {
+            ++*this;
+          }
 
-    namespace views
-    {
-      // COBS Encoder: Range<Range<byte>> -> Range<byte>
-      // Encodes multiple frames into a single COBS stream
+          // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+          // counted, when the iterator moves past its error
+          std::uint64_t resync_bytes() const noexcept
+          {
+            return resync_bytes_;
+          }
+
+          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.finished_;
+          }
+        };
+
+        iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_) };
+        }
+
+        std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // rCOBS Encoder: Range<Range<byte>> -> Range<byte>
+      // Reverse COBS: each code byte follows its block, so no lookahead is needed and every
+      // input byte can be emitted as soon as it is read
       template <std::ranges::input_range R>
         requires ByteRangeRange<R>
-      class encode : public std::ranges::view_interface<encode<R>>
+      class encode_rcobs : public std::ranges::view_interface<encode_rcobs<R>>
       {
         using Base = std::views::all_t<R>;
         Base base_;
         bool append_delim_;
 
       public:
-        encode() = default;
-        encode(R r, bool append_delim = true)
+        encode_rcobs() = default;
+        encode_rcobs(R r, bool append_delim = true)
             : base_(std::views::all(std::move(r)))
             , append_delim_(append_delim)
         {
         }
 
-        encode(const encode &) = delete;
-        encode &operator=(const encode &) = delete;
-        encode(encode &&) = default;
-        encode &operator=(encode &&) = default;
+        encode_rcobs(const encode_rcobs &) = delete;
+        encode_rcobs &operator=(const encode_rcobs &) = delete;
+        encode_rcobs(encode_rcobs &&) = default;
+        encode_rcobs &operator=(encode_rcobs &&) = default;
 
         class iterator
         {
           using BaseIter = std::ranges::iterator_t<Base>;
           using BaseSent = std::ranges::sentinel_t<Base>;
+          using FrameIter = std::ranges::iterator_t<std::ranges::range_value_t<Base>>;
+          using FrameSent = std::ranges::sentinel_t<std::ranges::range_value_t<Base>>;
 
           BaseIter frames_it_;
           BaseSent frames_end_;
           bool append_delim_;
 
-          std::ranges::iterator_t<std::ranges::range_value_t<Base>> current_frame_it_;
-          std::ranges::sentinel_t<std::ranges::range_value_t<Base>> current_frame_end_;
+          FrameIter current_frame_it_;
+          FrameSent current_frame_end_;
 
           std::array<std::byte, 255> unit_buffer_;
           std::size_t unit_size_ = 0;
           std::size_t unit_pos_ = 0;
+          std::size_t run_ = 0; // Non-zero bytes emitted since the last code byte
           enum class encode_state
           {
             start_of_frame,
-            start_of_chunk,
             on_byte,
-            end_of_chunk,
-            end_of_last_chunk,
             end_of_frame,
             finished,
           };
@@ -109,6 +3671,24 @@ namespace mamecobs
             ++frames_it_;
           }
 
+          // Contiguous fast path: emit the whole available non-zero run as one unit
+          void scan_run()
+          {
+            if constexpr (ContiguousBytes<FrameIter, FrameSent>)
+            {
+              const std::byte *first = as_bytes_ptr(current_frame_it_);
+              std::size_t avail =
+                  std::min(254 - run_, static_cast<std::size_t>(current_frame_end_ - current_frame_it_));
+              std::size_t run = static_cast<std::size_t>(
+                  kernels::find_byte(first, first + avail, std::byte{ 0 }) - first
+              );
+              std::memcpy(unit_buffer_.data(), first, run);
+              unit_size_ = run;
+              run_ += run;
+              current_frame_it_ += static_cast<std::iter_difference_t<FrameIter>>(run);
+            }
+          }
+
           encode_state process_start_of_frame()
           {
             if (!can_start_next_frame())
@@ -117,52 +3697,53 @@ namespace mamecobs
             }
 
             setup_next_frame();
-            return encode_state::start_of_chunk;
-          }
-
-          encode_state process_start_of_chunk()
-          {
-            unit_size_ = 1;
+            run_ = 0;
             return encode_state::on_byte;
           }
 
           encode_state process_on_byte()
           {
-            if (current_frame_it_ == current_frame_end_)
+            unit_size_ = 0;
+            scan_run();
+
+            if (254 <= run_)
             {
-              return encode_state::end_of_last_chunk;
+              unit_buffer_[unit_size_++] = std::byte{ 0xFF };
+              run_ = 0;
+              return encode_state::on_byte;
             }
 
-            if (255 <= unit_size_)
+            if (unit_size_ != 0)
             {
-              return encode_state::end_of_chunk;
+              return encode_state::on_byte;
+            }
+
+            if (current_frame_it_ == current_frame_end_)
+            {
+              // The implicit trailing zero closes the last block
+              unit_buffer_[unit_size_++] = static_cast<std::byte>(run_ + 1);
+              return encode_state::end_of_frame;
             }
 
             std::byte b = to_byte(*current_frame_it_);
             ++current_frame_it_;
-            if (b == frame_delim)
+            if (b == std::byte{ 0 })
             {
-              return encode_state::end_of_chunk;
+              unit_buffer_[unit_size_++] = static_cast<std::byte>(run_ + 1);
+              run_ = 0;
+              return encode_state::on_byte;
             }
 
-            unit_buffer_[unit_size_] = b;
-            ++unit_size_;
-
+            unit_buffer_[unit_size_++] = b;
+            ++run_;
+            if (254 <= run_)
+            {
+              unit_buffer_[unit_size_++] = std::byte{ 0xFF };
+              run_ = 0;
+            }
             return encode_state::on_byte;
           }
 
-          encode_state process_end_of_chunk()
-          {
-            unit_buffer_[0] = static_cast<std::byte>(unit_size_);
-            return encode_state::start_of_chunk;
-          }
-
-          encode_state process_end_of_last_chunk()
-          {
-            unit_buffer_[0] = static_cast<std::byte>(unit_size_);
-            return encode_state::end_of_frame;
-          }
-
           encode_state process_end_of_frame()
           {
             if (append_delim_ || can_start_next_frame())
@@ -178,7 +3759,7 @@ namespace mamecobs
 
           bool build_next_unit()
           {
-            unit_pos_ = 0; // unit_size_ は状態関数で管理
+            unit_pos_ = 0;
 
             while (true)
             {
@@ -187,21 +3768,16 @@ namespace mamecobs
               case encode_state::start_of_frame:
                 state_ = process_start_of_frame();
                 break;
-              case encode_state::start_of_chunk:
-                state_ = process_start_of_chunk();
-                break;
               case encode_state::on_byte:
                 state_ = process_on_byte();
-                break;
-              case encode_state::end_of_chunk:
-                state_ = process_end_of_chunk();
-                return true;
-              case encode_state::end_of_last_chunk:
-                state_ = process_end_of_last_chunk();
                 return true;
               case encode_state::end_of_frame:
                 state_ = process_end_of_frame();
-                return true;
+                if (unit_size_ != 0)
+                {
+                  return true;
+                }
+                break;
               case encode_state::finished:
                 unit_size_ = 0;
                 return false;
@@ -210,31 +3786,285 @@ namespace mamecobs
           }
 
         public:
-          using value_type = std::byte;
+          using value_type = std::byte;
+          using difference_type = std::ptrdiff_t;
+          using iterator_category = std::input_iterator_tag;
+
+          iterator() = default;
+          iterator(BaseIter it, BaseSent end, bool append_delim)
+              : frames_it_(it)
+              , frames_end_(end)
+              , append_delim_(append_delim)
+          {
+            build_next_unit();
+          }
+
+          std::byte operator*() const
+          {
+            return unit_buffer_[unit_pos_];
+          }
+
+          iterator &operator++()
+          {
+            ++unit_pos_;
+
+            if (unit_pos_ >= unit_size_)
+            {
+              build_next_unit();
+            }
+
+            return *this;
+          }
+
+          void operator++(int)
+          {
+            ++*this;
+          }
+
+          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
+          {
+            return it.state_ == encode_state::finished && it.unit_pos_ >= it.unit_size_;
+          }
+        };
+
+        iterator begin()
+        {
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), append_delim_ };
+        }
+
+        std::default_sentinel_t end()
+        {
+          return {};
+        }
+      };
+
+      // rCOBS Decoder: Range<byte> -> Range<expected<span<byte>, frame_error>>
+      // Collects an encoded frame up to its delimiter, then decodes it in place from the end
+      template <std::size_t MaxFrameSize, std::ranges::input_range R>
+        requires ByteLike<std::ranges::range_value_t<R>>
+      class decode_rcobs : public std::ranges::view_interface<decode_rcobs<MaxFrameSize, R>>
+      {
+        using Base = std::views::all_t<R>;
+        Base base_;
+
+      public:
+        static constexpr std::size_t max_frame_size = MaxFrameSize;
+        // Largest encoding of a MaxFrameSize frame: one 0xFF per 254 bytes plus the final code
+        static constexpr std::size_t max_encoded_size = MaxFrameSize + MaxFrameSize / 254 + 1;
+
+        decode_rcobs() = default;
+        explicit decode_rcobs(R r)
+            : base_(std::views::all(std::move(r)))
+        {
+        }
+
+        decode_rcobs(const decode_rcobs &) = delete;
+        decode_rcobs &operator=(const decode_rcobs &) = delete;
+        decode_rcobs(decode_rcobs &&) = default;
+        decode_rcobs &operator=(decode_rcobs &&) = default;
+
+        class iterator
+        {
+          using BaseIter = std::ranges::iterator_t<Base>;
+          using BaseSent = std::ranges::sentinel_t<Base>;
+
+          BaseIter it_;
+          BaseSent end_;
+
+          std::array<std::byte, max_encoded_size> frame_buffer_;
+          std::size_t staged_size_ = 0; // Encoded bytes collected at the front of frame_buffer_
+          std::size_t frame_begin_ = 0; // Decoded frame occupies [frame_begin_, max_encoded_size)
+
+          std::optional<decode_error> current_error_;
+          bool resync_ = false; // Error raised before the frame's delimiter was consumed
+          bool finished_ = false;
+
+          std::uint64_t offset_ = 0;
+          std::uint64_t frame_start_ = 0;
+          std::uint64_t frame_index_ = 0;
+          std::uint64_t resync_bytes_ = 0; // Input skipped while resynchronising, delimiters included
+          frame_error failure_{ decode_error::incomplete };
+
+          void skip_to_delimiter()
+          {
+            std::uint64_t start = offset_;
+            if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+            {
+              const std::byte *first = as_bytes_ptr(it_);
+              auto n = kernels::find_byte(first, first + (end_ - it_), frame_delim) - first;
+              it_ += n;
+              offset_ += static_cast<std::uint64_t>(n);
+            }
+
+            while (it_ != end_)
+            {
+              ++offset_;
+              if (to_byte(*it_) == frame_delim)
+              {
+                ++it_;
+                break;
+              }
+              ++it_;
+            }
+            resync_bytes_ += offset_ - start;
+          }
+
+          // Errors found while staging are reported at the byte that failed the frame, those found
+          // while unstuffing at its delimiter
+          void fail_frame(std::uint64_t at)
+          {
+            failure_ = frame_error{ *current_error_, at, frame_index_, offset_ - frame_start_ };
+          }
+
+          // Collects the encoded frame; returns false at end of stream or on error
+          bool stage_frame()
+          {
+            staged_size_ = 0;
+            bool any = false;
+
+            while (it_ != end_)
+            {
+              any = true;
+              if constexpr (ContiguousBytes<BaseIter, BaseSent>)
+              {
+                const std::byte *first = as_bytes_ptr(it_);
+                std::size_t avail =
+                    std::min(max_encoded_size - staged_size_, static_cast<std::size_t>(end_ - it_));
+                std::size_t n =
+                    static_cast<std::size_t>(kernels::find_byte(first, first + avail, frame_delim) - first);
+                std::memcpy(frame_buffer_.data() + staged_size_, first, n);
+                staged_size_ += n;
+                it_ += static_cast<std::iter_difference_t<BaseIter>>(n);
+                offset_ += n;
+                if (it_ == end_)
+                {
+                  break;
+                }
+              }
+
+              std::byte b = to_byte(*it_);
+              if (b == frame_delim)
+              {
+                ++it_;
+                ++offset_;
+                return true;
+              }
+
+              if (max_encoded_size <= staged_size_)
+              {
+                current_error_ = decode_error::oversized;
+                resync_ = true;
+                fail_frame(offset_);
+                return false;
+              }
+
+              frame_buffer_[staged_size_] = b;
+              ++staged_size_;
+              ++it_;
+              ++offset_;
+            }
+
+            if (any)
+            {
+              current_error_ = decode_error::incomplete;
+              fail_frame(offset_);
+            }
+            return false;
+          }
+
+          // Walks the code bytes from the end of the frame, moving each block to its final place
+          bool unstuff_frame()
+          {
+            std::size_t read = staged_size_;
+            std::size_t write = max_encoded_size;
+            bool last_block = true;
+
+            while (read != 0)
+            {
+              std::size_t code = static_cast<std::size_t>(frame_buffer_[read - 1]);
+              --read;
+
+              std::size_t data = code - 1;
+              if (read < data)
+              {
+                current_error_ = decode_error::invalid_cobs;
+                return false;
+              }
+
+              if (!last_block && code < 255)
+              {
+                frame_buffer_[--write] = std::byte{ 0 };
+              }
+
+              write -= data;
+              read -= data;
+              std::memmove(frame_buffer_.data() + write, frame_buffer_.data() + read, data);
+              last_block = false;
+            }
+
+            frame_begin_ = write;
+            if (MaxFrameSize < max_encoded_size - frame_begin_)
+            {
+              current_error_ = decode_error::oversized;
+              return false;
+            }
+            return true;
+          }
+
+          bool decode_next_frame()
+          {
+            current_error_.reset();
+            frame_start_ = offset_;
+
+            if (!stage_frame())
+            {
+              finished_ = !current_error_;
+              return false;
+            }
+
+            if (!unstuff_frame())
+            {
+              fail_frame(offset_ - 1);
+              return false;
+            }
+            return true;
+          }
+
+        public:
+          using frame_type = std::span<const std::byte>;
+          using value_type = std::expected<frame_type, frame_error>;
           using difference_type = std::ptrdiff_t;
           using iterator_category = std::input_iterator_tag;
 
           iterator() = default;
-          iterator(BaseIter it, BaseSent end, bool append_delim)
-              : frames_it_(it)
-              , frames_end_(end)
-              , append_delim_(append_delim)
+          iterator(BaseIter it, BaseSent end)
+              : it_(it)
+              , end_(end)
           {
-            build_next_unit();
+            finished_ = !decode_next_frame() && !current_error_;
           }
 
-          std::byte operator*() const
+          value_type operator*() const
           {
-            return unit_buffer_[unit_pos_];
+            if (current_error_)
+            {
+              return std::unexpected(failure_);
+            }
+            return frame_type{ frame_buffer_.data() + frame_begin_, max_encoded_size - frame_begin_ };
           }
 
           iterator &operator++()
           {
-            ++unit_pos_;
+            if (resync_)
+            {
+              skip_to_delimiter();
+              resync_ = false;
+            }
 
-            if (unit_pos_ >= unit_size_)
+            if (!finished_)
             {
-              build_next_unit();
+              ++frame_index_;
+              finished_ = !decode_next_frame() && !current_error_;
             }
 
             return *this;
@@ -245,15 +4075,22 @@ namespace mamecobs
             ++*this;
           }
 
+          // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+          // counted, when the iterator moves past its error
+          std::uint64_t resync_bytes() const noexcept
+          {
+            return resync_bytes_;
+          }
+
           friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
           {
-            return it.state_ == encode_state::finished && it.unit_pos_ >= it.unit_size_;
+            return it.finished_;
           }
         };
 
         iterator begin()
         {
-          return iterator{ std::ranges::begin(base_), std::ranges::end(base_), append_delim_ };
+          return iterator{ std::ranges::begin(base_), std::ranges::end(base_) };
         }
 
         std::default_sentinel_t end()
@@ -261,283 +4098,471 @@ namespace mamecobs
           return {};
         }
       };
+    } // namespace views
 
-      // COBS Decoder: Range<byte> -> Range<expected<span<byte>, error>>
-      // Decodes a COBS stream into multiple frames with error handling
-      template <std::size_t MaxFrameSize, std::ranges::input_range R>
-        requires ByteLike<std::ranges::range_value_t<R>>
-      class decode : public std::ranges::view_interface<decode<MaxFrameSize, R>>
-      {
-        using Base = std::views::all_t<R>;
-        Base base_;
-
-      public:
-        static constexpr std::size_t max_frame_size = MaxFrameSize;
+    // Budgeted COBS decoder for real-time loops: step(max_bytes) consumes at most max_bytes input bytes
+    // and returns, keeping its place mid-block or mid-resync for the next call. Frames and errors are
+    // the same as views::decode yields for the same input; an error is reported as soon as it is
+    // detected, and the rest of the failed frame is skipped by the steps that follow.
+    template <std::size_t MaxFrameSize, std::ranges::input_range R>
+      requires ByteLike<std::ranges::range_value_t<R>>
+    class step_decoder
+    {
+      using Base = std::views::all_t<R>;
+      using BaseIter = std::ranges::iterator_t<Base>;
+      using BaseSent = std::ranges::sentinel_t<Base>;
 
-        decode() = default;
-        explicit decode(R r)
-            : base_(std::views::all(std::move(r)))
-        {
-        }
+      Base base_;
+      block_parser<BaseIter, BaseSent> parser_;
+      buffer_output<MaxFrameSize> output_;
 
-        decode(const decode &) = delete;
-        decode &operator=(const decode &) = delete;
-        decode(decode &&) = default;
-        decode &operator=(decode &&) = default;
+    public:
+      explicit step_decoder(R r, std::byte delim = frame_delim)
+          : base_(std::views::all(std::forward<R>(r)))
+          , parser_(std::ranges::begin(base_), std::ranges::end(base_), delim)
+      {
+      }
 
-        class iterator
-        {
-          using BaseIter = std::ranges::iterator_t<Base>;
-          using BaseSent = std::ranges::sentinel_t<Base>;
+      // Holds iterators into base_, so it stays where it was constructed
+      step_decoder(const step_decoder &) = delete;
+      step_decoder &operator=(const step_decoder &) = delete;
 
-          BaseIter it_;
-          BaseSent end_;
+      step_status step(std::size_t max_bytes)
+      {
+        return parser_.step(output_, max_bytes);
+      }
 
-          std::array<std::byte, MaxFrameSize> frame_buffer_;
-          std::size_t frame_size_ = 0;
+      // The frame reported by the last step() returning step_status::frame; valid until the next step()
+      std::span<const std::byte> frame() const noexcept
+      {
+        return output_.frame();
+      }
 
-          std::optional<decode_error> current_error_;
-          bool frame_ready_ = false;
-          bool finished_ = false;
+      // The failure reported by the last step() returning step_status::error
+      const frame_error &error() const noexcept
+      {
+        return parser_.error();
+      }
 
-          enum class decode_state
-          {
-            wait_for_code,
-            read_data_bytes,
-            handle_zero,
-            frame_complete,
-            error_state,
-            finished
-          };
-          decode_state state_ = decode_state::wait_for_code;
+      // Input bytes consumed so far
+      std::uint64_t offset() const noexcept
+      {
+        return parser_.offset();
+      }
 
-          std::size_t code_ = 0;
-          std::size_t bytes_read_ = 0;
+      // Input bytes skipped while resynchronising so far; the rest of a failed frame is skipped, and
+      // counted, by the steps after its error
+      std::uint64_t resync_bytes() const noexcept
+      {
+        return parser_.resync_bytes();
+      }
+    };
 
-          void skip_to_delimiter()
-          {
-            while (it_ != end_)
-            {
-              if (to_byte(*it_) == frame_delim)
-              {
-                ++it_;
-                break;
-              }
-              ++it_;
-            }
-            current_error_.reset();
-            frame_ready_ = false;
-            state_ = decode_state::wait_for_code;
-          }
-          decode_state process_wait_for_code()
-          {
-            if (it_ == end_)
-            {
-              return decode_state::finished;
-            }
+    // Byte-at-a-time COBS decoder for interrupt handlers: a few words of state over a caller-provided
+    // buffer, no allocation, and a data-byte path of one compare, one store and two increments.
+    // Errors are reported as soon as they are detected; the rest of the failed frame is dropped quietly.
+    class byte_decoder
+    {
+      std::byte *buffer_;
+      std::size_t capacity_;
+      std::size_t size_ = 0;
+      std::size_t frame_size_ = 0;
+      std::uint8_t remaining_ = 0; // Data bytes left in the current block; 0 means a code byte is next
+      bool zero_pending_ = false;  // The current block ends in an implicit zero if another block follows
+      bool discarding_ = false;    // Dropping the rest of a failed frame
+      std::byte delim_;
+      decode_error error_ = decode_error::incomplete;
 
-            std::byte code_byte = to_byte(*it_);
-            ++it_;
+      void restart() noexcept
+      {
+        size_ = 0;
+        remaining_ = 0;
+        zero_pending_ = false;
+        discarding_ = false;
+      }
 
-            if (code_byte == frame_delim)
-            {
-              return decode_state::frame_complete;
-            }
+      push_status fail(decode_error kind) noexcept
+      {
+        error_ = kind;
+        remaining_ = 0;
+        discarding_ = true;
+        return push_status::error;
+      }
 
-            code_ = static_cast<std::size_t>(code_byte);
-            if (code_ == 0)
-            {
-              current_error_ = decode_error::invalid_cobs;
-              return decode_state::error_state;
-            }
+      push_status end_frame() noexcept
+      {
+        if (discarding_)
+        {
+          restart();
+          return push_status::need_more;
+        }
+        if (remaining_ != 0)
+        {
+          // A full buffer is reported first, as decode() does
+          error_ = size_ == capacity_ ? decode_error::oversized : decode_error::invalid_cobs;
+          restart();
+          return push_status::error;
+        }
+        frame_size_ = size_;
+        restart();
+        return push_status::frame_complete;
+      }
 
-            bytes_read_ = 0;
-            return decode_state::read_data_bytes;
+      push_status start_block(std::byte code_byte) noexcept
+      {
+        if (discarding_)
+        {
+          return push_status::need_more;
+        }
+        if (zero_pending_)
+        {
+          if (size_ == capacity_)
+          {
+            return fail(decode_error::oversized);
           }
+          buffer_[size_++] = std::byte{ 0 };
+        }
+        auto code = static_cast<std::uint8_t>(code_byte ^ delim_);
+        remaining_ = static_cast<std::uint8_t>(code - 1);
+        zero_pending_ = code != 255;
+        return push_status::need_more;
+      }
 
-          decode_state process_read_data_bytes()
-          {
-            if (code_ == 1)
-            {
-              return decode_state::handle_zero;
-            }
+    public:
+      explicit byte_decoder(std::span<std::byte> buffer, std::byte delim = frame_delim) noexcept
+          : buffer_(buffer.data())
+          , capacity_(buffer.size())
+          , delim_(delim)
+      {
+      }
 
-            while (bytes_read_ < code_ - 1 && it_ != end_)
-            {
-              if (MaxFrameSize <= frame_size_)
-              {
-                current_error_ = decode_error::oversized;
-                return decode_state::error_state;
-              }
+      push_status push_byte(std::byte b) noexcept
+      {
+        if (b == delim_) [[unlikely]]
+        {
+          return end_frame();
+        }
+        if (remaining_ != 0) [[likely]]
+        {
+          if (size_ == capacity_) [[unlikely]]
+          {
+            return fail(decode_error::oversized);
+          }
+          buffer_[size_++] = b ^ delim_;
+          --remaining_;
+          return push_status::need_more;
+        }
+        return start_block(b);
+      }
 
-              std::byte b = to_byte(*it_);
-              if (b == frame_delim)
-              {
-                current_error_ = decode_error::invalid_cobs;
-                return decode_state::error_state;
-              }
+      // The frame completed by the last push_byte(); valid until the next byte is pushed
+      std::span<const std::byte> frame() const noexcept
+      {
+        return { buffer_, frame_size_ };
+      }
 
-              frame_buffer_[frame_size_] = b;
-              ++frame_size_;
-              ++it_;
-              ++bytes_read_;
-            }
+      // Why the last push_byte() returned push_status::error. Unlike the range decoders this is not a
+      // frame_error: its offsets would cost a counter update on every byte of the interrupt path, and the
+      // caller, which feeds the bytes, can count them more cheaply if it needs to
+      decode_error error() const noexcept
+      {
+        return error_;
+      }
 
-            if (bytes_read_ == code_ - 1)
-            {
-              return decode_state::handle_zero;
-            }
+      // Drops any partial frame, e.g. after a line break or timeout
+      void reset() noexcept
+      {
+        restart();
+      }
+    };
 
-            current_error_ = decode_error::incomplete;
-            return decode_state::error_state;
+    // Decodes the delimiter-free frame src[0, n) to dst for decode_batch(). Blocks of up to 32 bytes are
+    // copied as whole windows when src_room and dst_room, the bytes readable at src and writable at dst,
+    // allow it. Returns the decoded size, or nullopt when the last block runs past the end of the frame.
+    inline std::optional<std::size_t> decode_delimited(
+        const std::byte *src,
+        std::size_t n,
+        std::size_t src_room,
+        std::byte *dst,
+        std::size_t dst_room,
+        std::byte delim
+    ) noexcept
+    {
+      constexpr std::size_t window = 32;
+      std::size_t in = 0;
+      std::size_t out = 0;
+      while (in < n)
+      {
+        // Inside a frame no byte equals the delimiter, so every code is at least 1
+        std::size_t len = static_cast<std::size_t>(src[in] ^ delim) - 1;
+        ++in;
+        if (n - in < len)
+        {
+          return std::nullopt;
+        }
+        if (len <= window && window <= src_room - in && window <= dst_room - out)
+        {
+          std::array<std::byte, window> chunk;
+          std::memcpy(chunk.data(), src + in, window);
+          for (auto &b : chunk)
+          {
+            b ^= delim;
           }
+          std::memcpy(dst + out, chunk.data(), window);
+        }
+        else
+        {
+          kernels::copy_xor(dst + out, src + in, len, delim);
+        }
+        in += len;
+        out += len;
+        if (len != 254 && in < n)
+        {
+          dst[out++] = std::byte{ 0 };
+        }
+      }
+      return out;
+    }
 
-          decode_state process_handle_zero()
-          {
-            if (255 <= code_)
-            {
-              return decode_state::wait_for_code;
-            }
+    namespace adapters
+    {
+      template <cobs_variant Variant = cobs_variant::standard,
+                class Checksum = no_checksum,
+                class Observer = null_observer>
+      struct encode
+      {
+        bool append_delim_;
+        std::byte delim_;
 
-            if (it_ == end_)
-            {
-              current_error_ = decode_error::incomplete;
-              return decode_state::error_state;
-            }
+        constexpr explicit encode(bool append_delim, std::byte delim = frame_delim)
+            : append_delim_(append_delim)
+            , delim_(delim)
+        {
+        }
 
-            std::byte next = to_byte(*it_);
-            if (next == frame_delim)
-            {
-              ++it_;
-              return decode_state::frame_complete;
-            }
+        // Frames of compile-time size take the specialised encoder when nothing else hooks the state machine
+        static constexpr bool fixed_size_capable = Variant == cobs_variant::standard &&
+                                                   std::same_as<Checksum, no_checksum> &&
+                                                   std::same_as<Observer, null_observer>;
 
-            if (frame_size_ >= MaxFrameSize)
-            {
-              current_error_ = decode_error::oversized;
-              return decode_state::error_state;
-            }
-            frame_buffer_[frame_size_++] = std::byte{ 0 };
+        template <std::ranges::input_range R>
+          requires ByteRangeRange<R>
+        constexpr auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          if constexpr (fixed_size_capable && FixedSizeFrameRange<R_type>)
+          {
+            return views::encode_fixed<R_type>{ std::forward<R>(r), append_delim_, delim_ };
+          }
+          else
+          {
+            return views::encode<R_type, Variant, Checksum, Observer>{
+              std::forward<R>(r), append_delim_, delim_
+            };
+          }
+        }
 
-            return decode_state::wait_for_code;
+        // Trivially copyable structs are encoded as their object representation
+        template <std::ranges::input_range R>
+          requires FixedSizeFrameRange<R> && (!ByteRangeRange<R>)
+        constexpr auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          if constexpr (fixed_size_capable)
+          {
+            return views::encode_fixed<R_type>{ std::forward<R>(r), append_delim_, delim_ };
+          }
+          else
+          {
+            // views::encode walks each frame in place, so the structs must outlive the dereference
+            static_assert(std::is_lvalue_reference_v<std::ranges::range_reference_t<R_type>>,
+                          "struct frames must be stored in the range for this encoder");
+            auto frames = std::views::all(std::forward<R>(r)) | std::views::transform([](const auto &frame) {
+                            return std::as_bytes(std::span{ &frame, 1 });
+                          });
+            using FramesType = decltype(frames);
+            return views::encode<FramesType, Variant, Checksum, Observer>{
+              std::move(frames), append_delim_, delim_
+            };
           }
+        }
 
-          decode_state process_frame_complete()
+        template <std::ranges::input_range R>
+          requires ByteRange<R> && (!ByteRangeRange<R>)
+        constexpr auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          if constexpr (fixed_size_capable && FixedSizeFrame<R_type>)
+          {
+            // A single byte array or static-extent span takes the fixed-size encoder as well
+            auto frames = std::views::single(R_type(std::forward<R>(r)));
+            return views::encode_fixed<decltype(frames)>{ std::move(frames), append_delim_, delim_ };
+          }
+          else
           {
-            frame_ready_ = true;
-            return decode_state::wait_for_code;
+            auto single_frame = std::views::all(std::forward<R>(r));
+            auto frames = std::views::single(single_frame);
+            using FramesType = decltype(frames);
+            return views::encode<FramesType, Variant, Checksum, Observer>{ frames, append_delim_, delim_ };
           }
+        }
 
-          decode_state process_error_state()
+        // A single struct frame, encoded as its object representation
+        template <class T>
+          requires FixedSizeFrame<std::remove_cvref_t<T>> && (!std::ranges::range<std::remove_cvref_t<T>>)
+        constexpr auto operator()(T &&frame) const
+        {
+          using Frame = std::remove_cvref_t<T>;
+          if constexpr (fixed_size_capable)
           {
-            return decode_state::error_state;
+            auto frames = std::views::single(Frame(std::forward<T>(frame)));
+            return views::encode_fixed<decltype(frames)>{ std::move(frames), append_delim_, delim_ };
           }
-
-          bool decode_next_frame()
+          else
           {
-            frame_size_ = 0;
-            frame_ready_ = false;
-            current_error_.reset();
-            state_ = decode_state::wait_for_code;
+            auto frames = std::views::single(std::bit_cast<std::array<std::byte, sizeof(Frame)>>(frame));
+            using FramesType = decltype(frames);
+            return views::encode<FramesType, Variant, Checksum, Observer>{ frames, append_delim_, delim_ };
+          }
+        }
 
-            while (true)
-            {
-              switch (state_)
-              {
-              case decode_state::wait_for_code:
-                state_ = process_wait_for_code();
-                break;
+        template <ByteLike T>
+        constexpr auto operator()(T &&b) const
+        {
+          auto single_byte = std::views::single(to_byte(b));
+          auto frames = std::views::single(single_byte);
+          using FramesType = decltype(frames);
+          return views::encode<FramesType, Variant, Checksum, Observer>{ frames, append_delim_, delim_ };
+        }
+      };
 
-              case decode_state::read_data_bytes:
-                state_ = process_read_data_bytes();
-                break;
+      // Gather encoder: a range of segments is one frame, a range of such ranges is many frames
+      template <cobs_variant Variant = cobs_variant::standard,
+                class Checksum = no_checksum,
+                class Observer = null_observer>
+      struct encode_gather
+      {
+        bool append_delim_;
+        std::byte delim_;
 
-              case decode_state::handle_zero:
-                state_ = process_handle_zero();
-                break;
+        explicit encode_gather(bool append_delim, std::byte delim = frame_delim)
+            : append_delim_(append_delim)
+            , delim_(delim)
+        {
+        }
 
-              case decode_state::frame_complete:
-                state_ = process_frame_complete();
-                return true; // Frame successfully decoded
+        template <std::ranges::input_range R>
+          requires SegmentedFrameRange<R>
+        auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          return views::encode<R_type, Variant, Checksum, Observer>{
+            std::forward<R>(r), append_delim_, delim_
+          };
+        }
 
-              case decode_state::error_state:
-                return false; // Error occurred
+        template <std::ranges::input_range R>
+          requires ByteRangeRange<R>
+        auto operator()(R &&r) const
+        {
+          auto segments = std::views::all(std::forward<R>(r));
+          auto frames = std::views::single(segments);
+          using FramesType = decltype(frames);
+          return views::encode<FramesType, Variant, Checksum, Observer>{ frames, append_delim_, delim_ };
+        }
+      };
 
-              case decode_state::finished:
-                finished_ = true;
-                return false; // No more data
-              }
-            }
-          }
+      struct encode_zpe
+      {
+        bool append_delim_;
 
-        public:
-          using frame_type = std::span<const std::byte>;
-          using value_type = std::expected<frame_type, decode_error>;
-          using difference_type = std::ptrdiff_t;
-          using iterator_category = std::input_iterator_tag;
+        explicit encode_zpe(bool append_delim)
+            : append_delim_(append_delim)
+        {
+        }
 
-          iterator() = default;
-          iterator(BaseIter it, BaseSent end)
-              : it_(it)
-              , end_(end)
-          {
-            finished_ = !decode_next_frame() && !current_error_;
-          }
+        template <std::ranges::input_range R>
+          requires ByteRangeRange<R>
+        auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          return views::encode_zpe<R_type>{ std::forward<R>(r), append_delim_ };
+        }
 
-          value_type operator*() const
-          {
-            if (current_error_)
-            {
-              return std::unexpected(*current_error_);
-            }
-            return frame_type{ frame_buffer_.data(), frame_size_ };
-          }
+        template <std::ranges::input_range R>
+          requires ByteRange<R> && (!ByteRangeRange<R>)
+        auto operator()(R &&r) const
+        {
+          auto single_frame = std::views::all(std::forward<R>(r));
+          auto frames = std::views::single(single_frame);
+          using FramesType = decltype(frames);
+          return views::encode_zpe<FramesType>{ frames, append_delim_ };
+        }
+      };
 
-          iterator &operator++()
-          {
-            if (current_error_)
-            {
-              skip_to_delimiter();
-            }
+      template <class Provider, class Checksum = no_checksum, class Observer = null_observer>
+      struct decode_into
+      {
+        Provider provider_;
+        std::byte delim_ = frame_delim;
 
-            if (!finished_)
-            {
-              finished_ = !decode_next_frame() && !current_error_;
-            }
+        template <std::ranges::input_range R>
+          requires ByteRange<R>
+        auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          return views::decode_into<R_type, Provider, Checksum, Observer>{
+            std::forward<R>(r), provider_, delim_
+          };
+        }
+      };
 
-            return *this;
-          }
+      template <std::size_t SegmentSize, class Sink>
+      struct decode_segmented
+      {
+        Sink *sink_;
+        std::byte delim_ = frame_delim;
 
-          void operator++(int)
-          {
-            ++*this;
-          }
+        template <std::ranges::input_range R>
+          requires ByteRange<R>
+        auto operator()(R &&r) const
+        {
+          using R_type = std::remove_cvref_t<R>;
+          return views::decode_segmented<SegmentSize, R_type, Sink>{ std::forward<R>(r), *sink_, delim_ };
+        }
+      };
 
-          friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept
-          {
-            return it.finished_;
-          }
-        };
+      template <class T>
+      struct decode_as
+      {
+        std::byte delim_ = frame_delim;
 
-        iterator begin()
+        template <std::ranges::input_range R>
+          requires ByteRange<R>
+        auto operator()(R &&r) const
         {
-          return iterator{ std::ranges::begin(base_), std::ranges::end(base_) };
+          using R_type = std::remove_cvref_t<R>;
+          return views::decode_as<R_type, T>{ std::forward<R>(r), delim_ };
         }
+      };
 
-        std::default_sentinel_t end()
+      template <std::size_t MaxFrameSize = 4096>
+      struct decode_zpe
+      {
+        template <std::ranges::input_range R>
+          requires ByteRange<R>
+        auto operator()(R &&r) const
         {
-          return {};
+          using R_type = std::remove_cvref_t<R>;
+          return views::decode_zpe<MaxFrameSize, R_type>{ std::forward<R>(r) };
         }
       };
-    } // namespace views
 
-    namespace adapters
-    {
-      struct encode
+      struct encode_rcobs
       {
         bool append_delim_;
 
-        explicit encode(bool append_delim)
+        explicit encode_rcobs(bool append_delim)
             : append_delim_(append_delim)
         {
         }
@@ -547,7 +4572,7 @@ namespace mamecobs
         auto operator()(R &&r) const
         {
           using R_type = std::remove_cvref_t<R>;
-          return views::encode<R_type>{ std::forward<R>(r), append_delim_ };
+          return views::encode_rcobs<R_type>{ std::forward<R>(r), append_delim_ };
         }
 
         template <std::ranges::input_range R>
@@ -557,71 +4582,316 @@ namespace mamecobs
           auto single_frame = std::views::all(std::forward<R>(r));
           auto frames = std::views::single(single_frame);
           using FramesType = decltype(frames);
-          return views::encode<FramesType>{ frames, append_delim_ };
+          return views::encode_rcobs<FramesType>{ frames, append_delim_ };
         }
+      };
 
-        template <ByteLike T>
-        auto operator()(T &&b) const
+      template <std::size_t MaxFrameSize = 4096>
+      struct decode_rcobs
+      {
+        template <std::ranges::input_range R>
+          requires ByteRange<R>
+        auto operator()(R &&r) const
         {
-          auto single_byte = std::views::single(to_byte(b));
-          auto frames = std::views::single(single_byte);
-          using FramesType = decltype(frames);
-          return views::encode<FramesType>{ frames, append_delim_ };
+          using R_type = std::remove_cvref_t<R>;
+          return views::decode_rcobs<MaxFrameSize, R_type>{ std::forward<R>(r) };
         }
       };
 
-      template <std::size_t MaxFrameSize = 4096>
+      template <std::size_t MaxFrameSize = 4096,
+                cobs_variant Variant = cobs_variant::standard,
+                class Checksum = no_checksum,
+                class Observer = null_observer,
+                class Loop = state_machine_loop>
       struct decode
       {
+        std::byte delim_ = frame_delim;
+
         template <std::ranges::input_range R>
           requires ByteRange<R>
-        auto operator()(R &&r) const
+        constexpr auto operator()(R &&r) const
         {
           using R_type = std::remove_cvref_t<R>;
-          return views::decode<MaxFrameSize, R_type>{ std::forward<R>(r) };
+          return views::decode<MaxFrameSize, R_type, Variant, Checksum, Observer, Loop>{
+            std::forward<R>(r), delim_
+          };
         }
 
         template <ByteLike T>
-        auto operator()(T &&b) const
+        constexpr auto operator()(T &&b) const
         {
           auto chunk = std::views::single(to_byte(b));
           using ChunkType = decltype(chunk);
-          return views::decode<MaxFrameSize, ChunkType>{ chunk };
+          return views::decode<MaxFrameSize, ChunkType, Variant, Checksum, Observer, Loop>{ chunk, delim_ };
         }
       };
     } // namespace adapters
   } // anonymous namespace
 
-  inline auto encode(bool append_delim = true)
+  // delim selects the frame delimiter; the output is XOR-ed with it so it never appears inside a frame.
+  // Checksum (e.g. crc32c) is computed while the payload is scanned and encoded after it.
+  // Observer (e.g. stats_observer) is told about every encoded frame.
+  template <class Checksum = no_checksum, class Observer = null_observer>
+  constexpr auto encode(bool append_delim = true, std::byte delim = frame_delim)
+  {
+    return adapters::encode<cobs_variant::standard, Checksum, Observer>{ append_delim, delim };
+  }
+
+  // Checksum verifies and strips the trailer added by encode<Checksum>(); mismatches are
+  // reported as decode_error::checksum_mismatch
+  // Observer is told about decoded frames, errors and bytes skipped while resynchronising.
+  // Loop selects the scalar decode loop (state_machine_loop, branch_light_loop or unchecked_loop).
+  template <std::size_t MaxFrameSize = 4096,
+            class Checksum = no_checksum,
+            class Observer = null_observer,
+            class Loop = state_machine_loop>
+  constexpr auto decode(std::byte delim = frame_delim)
+  {
+    return adapters::decode<MaxFrameSize, cobs_variant::standard, Checksum, Observer, Loop>{ delim };
+  }
+
+  // Trusted-input decoding without validation; undefined results on malformed input (see unchecked_loop)
+  template <std::size_t MaxFrameSize = 4096, class Checksum = no_checksum, class Observer = null_observer>
+  constexpr auto decode_unchecked(std::byte delim = frame_delim)
+  {
+    return adapters::decode<MaxFrameSize, cobs_variant::standard, Checksum, Observer, unchecked_loop>{
+      delim
+    };
+  }
+
+  // Batch decoding of a buffer holding many small frames, without per-frame iterator setup: the
+  // delimiters are found a vector window at a time, then each complete frame is decoded to output at
+  // its own input offset and described in frames. Stops when frames is full; decodes at most
+  // output.size() input bytes, and at most 4 GiB per call. output must not overlap input, and output
+  // bytes outside the reported frames are unspecified. Blocks cut by a delimiter are invalid_cobs.
+  inline batch_result decode_batch(
+      std::span<const std::byte> input,
+      std::span<std::byte> output,
+      std::span<batch_frame> frames,
+      std::byte delim = frame_delim
+  ) noexcept
+  {
+    input = input.first(std::min({ input.size(), output.size(), std::size_t{ UINT32_MAX } }));
+    const kernels::kernel_table &table = kernels::active_kernels();
+    std::array<std::uint32_t, 4 * kernels::find_all_window> delims;
+
+    batch_result result{};
+    std::size_t scanned = 0;
+    while (scanned < input.size() && result.frames < frames.size())
+    {
+      kernels::match_run run =
+          table.find_all(input.data() + scanned, input.size() - scanned, delim, delims.data(), delims.size());
+      for (std::size_t i = 0; i < run.count && result.frames < frames.size(); ++i)
+      {
+        std::size_t start = result.consumed;
+        std::size_t end = scanned + delims[i];
+        std::optional<std::size_t> size = decode_delimited(
+            input.data() + start,
+            end - start,
+            input.size() - start,
+            output.data() + start,
+            output.size() - start,
+            delim
+        );
+        batch_frame &frame = frames[result.frames++];
+        frame.offset = static_cast<std::uint32_t>(start);
+        frame.length = static_cast<std::uint32_t>(size ? *size : end + 1 - start);
+        frame.error = size ? std::nullopt : std::optional{ decode_error::invalid_cobs };
+        result.consumed = end + 1;
+      }
+      scanned += run.scanned;
+    }
+    return result;
+  }
+
+  // Budgeted decoding: the returned step_decoder consumes at most max_bytes input bytes per step(max_bytes)
+  template <std::size_t MaxFrameSize = 4096, std::ranges::input_range R>
+    requires ByteRange<R>
+  inline auto decode_stepwise(R &&r, std::byte delim = frame_delim)
+  {
+    return step_decoder<MaxFrameSize, R>{ std::forward<R>(r), delim };
+  }
+
+  // Encoded form of a frame known at compile time, delimiter included, as a std::array:
+  //   constexpr auto ping = cobs_literal<0x11, 0x00, 0x22>(); // 02 11 02 22 00
+  template <std::uint8_t... Bytes>
+  consteval auto cobs_literal()
+  {
+    constexpr std::size_t encoded_size = [] {
+      std::array<std::byte, sizeof...(Bytes)> payload{ std::byte{ Bytes }... };
+      return static_cast<std::size_t>(std::ranges::distance(payload | encode()));
+    }();
+
+    std::array<std::byte, sizeof...(Bytes)> payload{ std::byte{ Bytes }... };
+    std::array<std::byte, encoded_size> encoded{};
+    std::ranges::copy(payload | encode(), encoded.begin());
+    return encoded;
+  }
+
+  // COBS/R (reduced) variant: saves the trailing code byte when the frame ends in a large byte
+  template <class Checksum = no_checksum, class Observer = null_observer>
+  constexpr auto encode_cobsr(bool append_delim = true, std::byte delim = frame_delim)
+  {
+    return adapters::encode<cobs_variant::reduced, Checksum, Observer>{ append_delim, delim };
+  }
+
+  template <std::size_t MaxFrameSize = 4096, class Checksum = no_checksum, class Observer = null_observer>
+  constexpr auto decode_cobsr(std::byte delim = frame_delim)
   {
-    return adapters::encode{ append_delim };
+    return adapters::decode<MaxFrameSize, cobs_variant::reduced, Checksum, Observer>{ delim };
+  }
+
+  // Gather encode: the segments of a range (e.g. a header and a payload span) are encoded as one
+  // frame with no staging copy; a range of such segment lists encodes one frame per list.
+  template <class Checksum = no_checksum, class Observer = null_observer>
+  inline auto encode_gather(bool append_delim = true, std::byte delim = frame_delim)
+  {
+    return adapters::encode_gather<cobs_variant::standard, Checksum, Observer>{ append_delim, delim };
+  }
+
+  // Scatter decode: decoded bytes are written once, into the spans returned by
+  // provider(frame_offset); yields the size of each frame (see views::decode_into). Checksum and
+  // Observer work as in decode().
+  template <class Checksum = no_checksum, class Observer = null_observer, class Provider>
+  inline auto decode_into(Provider provider, std::byte delim = frame_delim)
+  {
+    return adapters::decode_into<Provider, Checksum, Observer>{ std::move(provider), delim };
+  }
+
+  // Segmented decode: frames of any size are streamed to sink (see FrameSink) in segments of at most
+  // SegmentSize bytes; yields the size of each frame. The sink is referenced, so it must outlive the view.
+  template <std::size_t SegmentSize = 4096, FrameSink Sink>
+  inline auto decode_segmented(Sink &sink, std::byte delim = frame_delim)
+  {
+    return adapters::decode_segmented<SegmentSize, Sink>{ &sink, delim };
+  }
+
+  // Typed decode: each frame must be exactly sizeof(T) bytes and is yielded as a T value
+  template <class T>
+    requires std::is_trivially_copyable_v<T>
+  inline auto decode_as(std::byte delim = frame_delim)
+  {
+    return adapters::decode_as<T>{ delim };
+  }
+
+  // COBS/ZPE variant: zero pairs and zero runs are folded into the code bytes
+  inline auto encode_zpe(bool append_delim = true)
+  {
+    return adapters::encode_zpe{ append_delim };
   }
 
   template <std::size_t MaxFrameSize = 4096>
-  inline auto decode()
+  inline auto decode_zpe()
+  {
+    return adapters::decode_zpe<MaxFrameSize>{};
+  }
+
+  // Reverse COBS: code bytes trail their blocks, so encoded bytes stream out with zero lookahead
+  inline auto encode_rcobs(bool append_delim = true)
+  {
+    return adapters::encode_rcobs{ append_delim };
+  }
+
+  template <std::size_t MaxFrameSize = 4096>
+  inline auto decode_rcobs()
+  {
+    return adapters::decode_rcobs<MaxFrameSize>{};
+  }
+
+  // Instruction set of the kernels selected for this process (cpuid, capped by MAMECOBS_SIMD)
+  inline simd_level active_simd_level() noexcept
+  {
+    return kernels::active_kernels().level;
+  }
+
+  template <std::ranges::input_range R, cobs_variant Variant, class Checksum, class Observer>
+  constexpr auto operator|(R &&r, const adapters::encode<Variant, Checksum, Observer> &adapter)
+  {
+    return adapter(std::forward<R>(r));
+  }
+
+  template <class T, cobs_variant Variant, class Checksum, class Observer>
+    requires FixedSizeFrame<std::remove_cvref_t<T>> && (!std::ranges::range<std::remove_cvref_t<T>>)
+  constexpr auto operator|(T &&frame, const adapters::encode<Variant, Checksum, Observer> &adapter)
+  {
+    return adapter(std::forward<T>(frame));
+  }
+
+  template <std::ranges::input_range R,
+            std::size_t MaxFrameSize,
+            cobs_variant Variant,
+            class Checksum,
+            class Observer,
+            class Loop>
+  constexpr auto operator|(
+      R &&r,
+      const adapters::decode<MaxFrameSize, Variant, Checksum, Observer, Loop> &adapter
+  )
+  {
+    return adapter(std::forward<R>(r));
+  }
+
+  template <std::ranges::input_range R, cobs_variant Variant, class Checksum, class Observer>
+  auto operator|(R &&r, const adapters::encode_gather<Variant, Checksum, Observer> &adapter)
+  {
+    return adapter(std::forward<R>(r));
+  }
+
+  template <std::ranges::input_range R, class Provider, class Checksum, class Observer>
+  auto operator|(R &&r, const adapters::decode_into<Provider, Checksum, Observer> &adapter)
+  {
+    return adapter(std::forward<R>(r));
+  }
+
+  template <std::ranges::input_range R, std::size_t SegmentSize, class Sink>
+  auto operator|(R &&r, const adapters::decode_segmented<SegmentSize, Sink> &adapter)
   {
-    return adapters::decode<MaxFrameSize>{};
+    return adapter(std::forward<R>(r));
+  }
+
+  template <std::ranges::input_range R, class T>
+  auto operator|(R &&r, const adapters::decode_as<T> &adapter)
+  {
+    return adapter(std::forward<R>(r));
+  }
+
+  template <std::ranges::input_range R>
+  auto operator|(R &&r, const adapters::encode_zpe &adapter)
+  {
+    return adapter(std::forward<R>(r));
+  }
+
+  template <std::ranges::input_range R, std::size_t MaxFrameSize>
+  auto operator|(R &&r, const adapters::decode_zpe<MaxFrameSize> &adapter)
+  {
+    return adapter(std::forward<R>(r));
   }
+
   template <std::ranges::input_range R>
-  auto operator|(R &&r, const adapters::encode &adapter)
+  auto operator|(R &&r, const adapters::encode_rcobs &adapter)
   {
     return adapter(std::forward<R>(r));
   }
 
   template <std::ranges::input_range R, std::size_t MaxFrameSize>
-  auto operator|(R &&r, const adapters::decode<MaxFrameSize> &adapter)
+  auto operator|(R &&r, const adapters::decode_rcobs<MaxFrameSize> &adapter)
   {
     return adapter(std::forward<R>(r));
   }
 
-  template <ByteLike T>
-  auto operator|(T &&b, const adapters::encode &adapter)
+  template <ByteLike T, cobs_variant Variant, class Checksum, class Observer>
+  auto operator|(T &&b, const adapters::encode<Variant, Checksum, Observer> &adapter)
   {
     return adapter(std::forward<T>(b));
   }
 
-  template <ByteLike T, std::size_t MaxFrameSize>
-  auto operator|(T &&b, const adapters::decode<MaxFrameSize> &adapter)
+  template <ByteLike T,
+            std::size_t MaxFrameSize,
+            cobs_variant Variant,
+            class Checksum,
+            class Observer,
+            class Loop>
+  auto operator|(T &&b, const adapters::decode<MaxFrameSize, Variant, Checksum, Observer, Loop> &adapter)
   {
     return adapter(std::forward<T>(b));
   }
@@ -0,0 +1,180 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <cstdint>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  // Mostly 8-40 byte frames, with a few empty, full-block and long ones
+  std::vector<std::vector<std::byte>> small_frames(std::size_t count, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> size(8, 40);
+    std::uniform_int_distribution<> value(0, 255);
+    std::vector<std::vector<std::byte>> frames(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      std::size_t n = static_cast<std::size_t>(size(gen));
+      n = i % 17 == 0 ? 0 : i % 29 == 0 ? 254 : i % 31 == 0 ? 700 : n;
+      for (std::size_t j = 0; j < n; ++j)
+      {
+        int v = value(gen);
+        frames[i].push_back(std::byte{ static_cast<unsigned char>(v < 30 ? 0 : v) });
+      }
+    }
+    return frames;
+  }
+
+  // Decodes all of input through repeated decode_batch() calls with room for batch_size frames each
+  struct batch_output
+  {
+    std::vector<std::vector<std::byte>> frames;
+    std::vector<batch_frame> results;
+    std::size_t consumed = 0;
+  };
+
+  batch_output decode_all(std::span<const std::byte> input,
+                          std::size_t batch_size,
+                          std::byte delim = frame_delim)
+  {
+    batch_output out;
+    std::vector<std::byte> output(input.size());
+    std::vector<batch_frame> frames(batch_size);
+    while (true)
+    {
+      auto rest = std::span(output).subspan(out.consumed);
+      batch_result r = decode_batch(input.subspan(out.consumed), rest, frames, delim);
+      for (std::size_t i = 0; i < r.frames; ++i)
+      {
+        batch_frame f = frames[i];
+        f.offset += static_cast<std::uint32_t>(out.consumed);
+        out.results.push_back(f);
+        if (!f.error)
+        {
+          out.frames.emplace_back(output.begin() + f.offset, output.begin() + f.offset + f.length);
+        }
+      }
+      out.consumed += r.consumed;
+      if (r.frames == 0)
+      {
+        return out;
+      }
+    }
+  }
+} // namespace
+
+UTEST(batch, matches_decode)
+{
+  auto frames = small_frames(2000, 49);
+  for (std::byte delim : { std::byte{ 0x00 }, std::byte{ 0x7E } })
+  {
+    auto encoded = collect_bytes(frames | encode(true, delim));
+    for (std::size_t batch_size : { std::size_t{ 1 }, std::size_t{ 7 }, std::size_t{ 4096 } })
+    {
+      batch_output out = decode_all(encoded, batch_size, delim);
+      ASSERT_EQ(out.consumed, encoded.size());
+      ASSERT_EQ(out.results.size(), frames.size());
+      ASSERT_TRUE(out.frames == frames);
+    }
+  }
+}
+
+UTEST(batch, offsets_follow_the_input)
+{
+  std::vector<std::vector<std::byte>> frames = {
+    { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x22 } }, {}, { std::byte{ 0x33 } }
+  };
+  auto encoded = collect_bytes(frames | encode());
+
+  std::vector<std::byte> output(encoded.size());
+  std::array<batch_frame, 8> results{};
+  batch_result r = decode_batch(encoded, output, results);
+  ASSERT_EQ(r.frames, 3u);
+  ASSERT_EQ(r.consumed, encoded.size());
+  ASSERT_EQ(results[0].offset, 0u);
+  ASSERT_EQ(results[0].length, 3u);
+  ASSERT_EQ(results[1].offset, 5u);
+  ASSERT_EQ(results[1].length, 0u);
+  ASSERT_EQ(results[2].offset, 7u);
+  ASSERT_EQ(results[2].length, 1u);
+  ASSERT_TRUE(output[0] == std::byte{ 0x11 });
+  ASSERT_TRUE(output[1] == std::byte{ 0x00 });
+  ASSERT_TRUE(output[2] == std::byte{ 0x22 });
+  ASSERT_TRUE(output[7] == std::byte{ 0x33 });
+}
+
+UTEST(batch, partial_tail_is_left_unconsumed)
+{
+  auto frames = small_frames(50, 50);
+  auto encoded = collect_bytes(frames | encode());
+  std::vector<std::byte> cut(encoded.begin(), encoded.end() - 3);
+
+  std::vector<std::vector<std::byte>> last = { frames.back() };
+  std::size_t last_size = collect_bytes(last | encode()).size();
+
+  batch_output out = decode_all(cut, 64);
+  ASSERT_EQ(out.results.size(), frames.size() - 1);
+  ASSERT_EQ(out.consumed, encoded.size() - last_size);
+}
+
+UTEST(batch, corrupted_frames_match_decode_errors)
+{
+  auto frames = small_frames(400, 51);
+  auto encoded = collect_bytes(frames | encode());
+  std::mt19937 gen(52);
+  std::uniform_int_distribution<std::size_t> at(0, encoded.size() - 1);
+  for (int i = 0; i < 20; ++i)
+  {
+    encoded[at(gen)] = std::byte{ 0 };
+  }
+
+  std::vector<std::vector<std::byte>> expected_frames;
+  std::vector<std::uint64_t> expected_errors;
+  auto decoded = encoded | decode<4096>();
+  auto it = decoded.begin();
+  for (; it != decoded.end(); ++it)
+  {
+    auto frame = *it;
+    if (frame)
+    {
+      expected_frames.emplace_back(frame->begin(), frame->end());
+    }
+    else
+    {
+      expected_errors.push_back(frame.error().discarded);
+    }
+  }
+  // Every error ends on its delimiter, the one byte resynchronisation counts for it
+  ASSERT_EQ(it.resync_bytes(), static_cast<std::uint64_t>(expected_errors.size()));
+
+  batch_output out = decode_all(encoded, 32);
+  std::vector<std::uint64_t> errors;
+  for (const batch_frame &f : out.results)
+  {
+    if (f.error)
+    {
+      ASSERT_TRUE(*f.error == decode_error::invalid_cobs);
+      errors.push_back(f.length);
+    }
+  }
+  ASSERT_FALSE(errors.empty());
+  ASSERT_TRUE(errors == expected_errors);
+  ASSERT_TRUE(out.frames == expected_frames);
+}
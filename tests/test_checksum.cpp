@@ -0,0 +1,245 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <cstdint>
+#include <list>
+#include <random>
+#include <ranges>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  // Bitwise reference CRC32C
+  std::uint32_t reference_crc32c(const std::vector<std::byte> &data)
+  {
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (auto b : data)
+    {
+      crc ^= static_cast<std::uint32_t>(b);
+      for (int bit = 0; bit < 8; ++bit)
+      {
+        crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+      }
+    }
+    return ~crc;
+  }
+
+  std::vector<std::byte> with_crc(std::vector<std::byte> data)
+  {
+    std::uint32_t crc = reference_crc32c(data);
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+      data.push_back(static_cast<std::byte>(crc >> shift));
+    }
+    return data;
+  }
+} // namespace
+
+UTEST(checksum, crc32c_check_value)
+{
+  const char *text = "123456789";
+  crc32c crc;
+  crc.update(reinterpret_cast<const std::byte *>(text), 9);
+  ASSERT_EQ(crc.value(), static_cast<std::uint32_t>(0xE3069283u));
+}
+
+UTEST(checksum, crc32c_matches_reference)
+{
+  std::mt19937 gen(30);
+  std::uniform_int_distribution<> dis(0, 255);
+
+  for (std::size_t size : { 0, 1, 7, 8, 9, 63, 64, 1000 })
+  {
+    std::vector<std::byte> data(size);
+    for (auto &b : data)
+    {
+      b = std::byte{ static_cast<unsigned char>(dis(gen)) };
+    }
+
+    crc32c crc;
+    crc.update(data.data(), data.size());
+    ASSERT_EQ(crc.value(), reference_crc32c(data));
+  }
+}
+
+UTEST(checksum, encode_appends_crc32c_inside_frame)
+{
+  std::vector<std::byte> payload = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+
+  auto framed = with_crc(payload);
+  auto fused = collect_bytes(payload | encode<crc32c>(true));
+  auto two_pass = collect_bytes(framed | encode(true));
+
+  ASSERT_EQ(fused.size(), two_pass.size());
+  for (size_t i = 0; i < fused.size(); ++i)
+  {
+    ASSERT_EQ(fused[i], two_pass[i]);
+  }
+}
+
+UTEST(checksum, encode_crc32c_random_frames)
+{
+  // Covers 254-byte block boundaries inside the trailer and both input paths
+  std::mt19937 gen(31);
+  std::uniform_int_distribution<> dis(0, 255);
+
+  for (std::size_t size : { 0, 1, 250, 251, 252, 253, 254, 255, 600 })
+  {
+    std::vector<std::byte> payload(size);
+    for (auto &b : payload)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 10 ? 0 : v) };
+    }
+    std::list<std::byte> listed(payload.begin(), payload.end());
+
+    auto framed = with_crc(payload);
+    auto two_pass = collect_bytes(framed | encode(true));
+    auto fused = collect_bytes(payload | encode<crc32c>(true));
+    auto fused_list = collect_bytes(listed | encode<crc32c>(true));
+
+    ASSERT_EQ(fused.size(), two_pass.size());
+    ASSERT_EQ(fused_list.size(), two_pass.size());
+    for (size_t i = 0; i < fused.size(); ++i)
+    {
+      ASSERT_EQ(fused[i], two_pass[i]);
+      ASSERT_EQ(fused_list[i], two_pass[i]);
+    }
+  }
+}
+
+UTEST(checksum, encode_crc32c_per_frame)
+{
+  std::vector<std::vector<std::byte>> frames = {
+    { std::byte{ 0x01 } }, {}, { std::byte{ 0x00 }, std::byte{ 0x02 } }
+  };
+
+  auto fused = collect_bytes(frames | encode<crc32c>(true));
+
+  std::vector<std::vector<std::byte>> expected_frames;
+  for (const auto &frame : frames)
+  {
+    expected_frames.push_back(with_crc(frame));
+  }
+  auto two_pass = collect_bytes(expected_frames | encode(true));
+
+  ASSERT_EQ(fused.size(), two_pass.size());
+  for (size_t i = 0; i < fused.size(); ++i)
+  {
+    ASSERT_EQ(fused[i], two_pass[i]);
+  }
+}
+
+UTEST(checksum, decode_verifies_and_strips_crc32c)
+{
+  std::vector<std::vector<std::byte>> frames = { { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x22 } },
+                                                 {},
+                                                 std::vector<std::byte>(300, std::byte{ 0x5A }) };
+
+  auto encoded = collect_bytes(frames | encode<crc32c>(true));
+  std::list<std::byte> encoded_stream(encoded.begin(), encoded.end());
+
+  std::vector<std::vector<std::byte>> decoded;
+  for (auto frame_result : encoded | decode<4096, crc32c>())
+  {
+    ASSERT_TRUE(frame_result.has_value());
+    decoded.emplace_back(frame_result->begin(), frame_result->end());
+  }
+  std::size_t list_frames = 0;
+  for (auto frame_result : encoded_stream | decode<4096, crc32c>())
+  {
+    ASSERT_TRUE(frame_result.has_value());
+    ASSERT_EQ(frame_result->size(), frames[list_frames].size());
+    ++list_frames;
+  }
+
+  ASSERT_EQ(list_frames, frames.size());
+  ASSERT_EQ(decoded.size(), frames.size());
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    ASSERT_EQ(decoded[i].size(), frames[i].size());
+    for (size_t j = 0; j < frames[i].size(); ++j)
+    {
+      ASSERT_EQ(decoded[i][j], frames[i][j]);
+    }
+  }
+}
+
+UTEST(checksum, decode_reports_mismatch_and_continues)
+{
+  std::vector<std::vector<std::byte>> frames = { { std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x33 } },
+                                                 { std::byte{ 0x44 } } };
+
+  auto encoded = collect_bytes(frames | encode<crc32c>(true));
+  encoded[2] ^= std::byte{ 0x01 }; // Corrupt a payload byte of the first frame
+
+  std::vector<bool> results;
+  for (auto frame_result : encoded | decode<4096, crc32c>())
+  {
+    results.push_back(frame_result.has_value());
+    if (!frame_result)
+    {
+      ASSERT_EQ(frame_result.error().kind, decode_error::checksum_mismatch);
+    }
+    else
+    {
+      ASSERT_EQ(frame_result->size(), static_cast<size_t>(1));
+    }
+  }
+
+  // The second frame must not be swallowed by error recovery
+  ASSERT_EQ(results.size(), static_cast<size_t>(2));
+  ASSERT_FALSE(results[0]);
+  ASSERT_TRUE(results[1]);
+}
+
+UTEST(checksum, decode_short_frame_is_mismatch)
+{
+  // A frame shorter than the digest cannot carry a checksum
+  std::vector<std::byte> input = {
+    std::byte{ 0x03 }, std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }
+  };
+
+  bool found_error = false;
+  for (auto frame_result : input | decode<4096, crc32c>())
+  {
+    ASSERT_FALSE(frame_result.has_value());
+    ASSERT_EQ(frame_result.error().kind, decode_error::checksum_mismatch);
+    found_error = true;
+  }
+  ASSERT_TRUE(found_error);
+}
+
+UTEST(checksum, cobsr_with_crc32c)
+{
+  std::vector<std::byte> payload = { std::byte{ 0x01 }, std::byte{ 0x00 }, std::byte{ 0xFE } };
+
+  auto encoded = collect_bytes(payload | encode_cobsr<crc32c>(true, std::byte{ 0x7E }));
+
+  std::size_t count = 0;
+  for (auto frame_result : encoded | decode_cobsr<64, crc32c>(std::byte{ 0x7E }))
+  {
+    ASSERT_TRUE(frame_result.has_value());
+    ASSERT_EQ(frame_result->size(), payload.size());
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+      ASSERT_EQ((*frame_result)[i], payload[i]);
+    }
+    ++count;
+  }
+  ASSERT_EQ(count, static_cast<size_t>(1));
+}
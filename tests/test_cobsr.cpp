@@ -0,0 +1,217 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <random>
+#include <ranges>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  template <typename Range>
+  std::vector<std::byte> collect_frames(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto frame_result : range)
+    {
+      if (frame_result.has_value())
+      {
+        auto frame = *frame_result;
+        result.insert(result.end(), frame.begin(), frame.end());
+      }
+    }
+    return result;
+  }
+} // namespace
+
+UTEST(cobsr, encode_folds_last_byte_into_code)
+{
+  // [0x11, 0x22, 0x00, 0x33] -> [0x03, 0x11, 0x22, 0x33] (plain COBS: 03 11 22 02 33)
+  std::vector<std::byte> input = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+  auto result = collect_bytes(input | encode_cobsr(false));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x03 }, std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(cobsr, encode_keeps_code_when_last_byte_is_small)
+{
+  // [0x11, 0x00, 0x01] -> [0x02, 0x11, 0x02, 0x01] (0x01 < code 0x02)
+  std::vector<std::byte> input = { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x01 } };
+  auto result = collect_bytes(input | encode_cobsr(false));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x02 }, std::byte{ 0x11 }, std::byte{ 0x02 }, std::byte{ 0x01 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(cobsr, encode_trailing_zero_unchanged)
+{
+  // [0x42, 0x00] -> [0x02, 0x42, 0x01, 0x00]
+  std::vector<std::byte> input = { std::byte{ 0x42 }, std::byte{ 0x00 } };
+  auto result = collect_bytes(input | encode_cobsr(true));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x02 }, std::byte{ 0x42 }, std::byte{ 0x01 }, std::byte{ 0x00 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(cobsr, decode_reduced_tail)
+{
+  // [0x03, 0x11, 0x22, 0x33, 0x00] -> [0x11, 0x22, 0x00, 0x33]
+  std::vector<std::byte> input = {
+    std::byte{ 0x03 }, std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x33 }, std::byte{ 0x00 }
+  };
+  auto result = collect_frames(input | decode_cobsr());
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(cobsr, decode_accepts_plain_cobs)
+{
+  // Plain COBS frames are valid COBS/R frames
+  std::vector<std::byte> input = { std::byte{ 0x03 }, std::byte{ 0x11 }, std::byte{ 0x22 },
+                                   std::byte{ 0x02 }, std::byte{ 0x33 }, std::byte{ 0x00 } };
+  auto result = collect_frames(input | decode_cobsr());
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(cobsr, decode_oversized_tail)
+{
+  // The folded byte still counts against MaxFrameSize
+  std::vector<std::byte> input = { std::byte{ 0x03 }, std::byte{ 0x11 }, std::byte{ 0x22 },
+                                   std::byte{ 0x33 }, std::byte{ 0x00 } };
+
+  bool found_error = false;
+  for (auto frame_result : input | decode_cobsr<3>())
+  {
+    if (!frame_result.has_value())
+    {
+      found_error = true;
+      ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
+    }
+  }
+
+  ASSERT_TRUE(found_error);
+}
+
+UTEST(cobsr, roundtrip_saves_one_byte)
+{
+  // 19 non-zero bytes ending in a large value: one byte shorter than plain COBS
+  std::vector<std::byte> original;
+  for (int i = 1; i <= 19; ++i)
+  {
+    original.push_back(std::byte{ static_cast<unsigned char>(0xE0 + i) });
+  }
+
+  auto plain = collect_bytes(original | encode(true));
+  auto reduced = collect_bytes(original | encode_cobsr(true));
+  ASSERT_EQ(reduced.size() + 1, plain.size());
+
+  auto result = collect_frames(reduced | decode_cobsr());
+  ASSERT_EQ(result.size(), original.size());
+  for (size_t i = 0; i < original.size(); ++i)
+  {
+    ASSERT_EQ(result[i], original[i]);
+  }
+}
+
+UTEST(cobsr, roundtrip_random_frames)
+{
+  std::mt19937 gen(26);
+  std::uniform_int_distribution<> dis(0, 255);
+  std::uniform_int_distribution<> len(0, 600);
+
+  for (int n = 0; n < 200; ++n)
+  {
+    std::vector<std::byte> original(static_cast<size_t>(len(gen)));
+    for (auto &b : original)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 40 ? 0 : v) };
+    }
+
+    auto encoded = collect_bytes(original | encode_cobsr(true));
+    std::vector<std::vector<std::byte>> frames;
+    for (auto frame_result : encoded | decode_cobsr())
+    {
+      ASSERT_TRUE(frame_result.has_value());
+      frames.emplace_back(frame_result->begin(), frame_result->end());
+    }
+
+    ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+    ASSERT_EQ(frames[0].size(), original.size());
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      ASSERT_EQ(frames[0][i], original[i]);
+    }
+  }
+}
+
+UTEST(cobsr, roundtrip_254_byte_boundary)
+{
+  // A full 254-byte block ending in 0xFF folds into the 0xFF code
+  for (size_t size : { 253, 254, 255, 508 })
+  {
+    std::vector<std::byte> original(size, std::byte{ 0x7F });
+    original.back() = std::byte{ 0xFF };
+
+    auto encoded = collect_bytes(original | encode_cobsr(true));
+    auto result = collect_frames(encoded | decode_cobsr());
+
+    ASSERT_EQ(result.size(), original.size());
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      ASSERT_EQ(result[i], original[i]);
+    }
+  }
+}
@@ -0,0 +1,102 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <std::size_t N>
+  constexpr std::array<std::byte, N> bytes(const std::uint8_t (&values)[N])
+  {
+    std::array<std::byte, N> out{};
+    for (std::size_t i = 0; i < N; ++i)
+    {
+      out[i] = std::byte{ values[i] };
+    }
+    return out;
+  }
+
+  // Encodes then decodes payload in a constant expression and reports whether it came back unchanged
+  template <class Payload>
+  constexpr bool roundtrips(const Payload &payload, std::byte delim = frame_delim)
+  {
+    std::array<std::byte, 1024> encoded{};
+    std::size_t encoded_size = 0;
+    for (auto b : payload | encode(true, delim))
+    {
+      encoded[encoded_size++] = b;
+    }
+
+    std::size_t frames = 0;
+    bool same = true;
+    for (auto frame : std::span(encoded).first(encoded_size) | decode<1024>(delim))
+    {
+      same = same && frame && std::ranges::equal(*frame, payload);
+      ++frames;
+    }
+    return same && frames == 1;
+  }
+
+  constexpr auto ping = cobs_literal<0x11, 0x00, 0x22>();
+  constexpr auto empty = cobs_literal<>();
+
+  static_assert(ping == bytes({ 0x02, 0x11, 0x02, 0x22, 0x00 }));
+  static_assert(empty == bytes({ 0x01, 0x00 }));
+  static_assert(roundtrips(bytes({ 0x00, 0x00, 0x01, 0x02, 0x00 })));
+  static_assert(roundtrips(bytes({ 0x7E, 0x00, 0x7E }), std::byte{ 0x7E }));
+  static_assert(roundtrips([] {
+    std::array<std::byte, 600> long_frame{};
+    for (std::size_t i = 0; i < long_frame.size(); ++i)
+    {
+      long_frame[i] = std::byte{ static_cast<std::uint8_t>(i % 255 + 1) };
+    }
+    return long_frame;
+  }()));
+} // namespace
+
+UTEST(constexpr_codec, literal_matches_runtime_encoder)
+{
+  std::array<std::byte, 3> payload = { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x22 } };
+  std::vector<std::byte> runtime;
+  for (auto b : payload | encode())
+  {
+    runtime.push_back(b);
+  }
+  ASSERT_TRUE(std::ranges::equal(runtime, ping));
+}
+
+UTEST(constexpr_codec, fixed_size_frames_and_cobsr_in_constant_expressions)
+{
+  constexpr auto fixed_size = [] {
+    std::array<std::array<std::byte, 4>, 2> frames = { bytes({ 1, 0, 2, 3 }), bytes({ 0, 0, 0, 0 }) };
+    std::size_t n = 0;
+    for ([[maybe_unused]] auto b : frames | encode())
+    {
+      ++n;
+    }
+    return n;
+  }();
+  ASSERT_EQ(fixed_size, 12u);
+
+  constexpr bool cobsr_roundtrip = [] {
+    auto payload = bytes({ 0x01, 0x00, 0xF0 });
+    std::array<std::byte, 8> encoded{};
+    std::size_t size = 0;
+    for (auto b : payload | encode_cobsr())
+    {
+      encoded[size++] = b;
+    }
+    bool same = false;
+    for (auto frame : std::span(encoded).first(size) | decode_cobsr<16>())
+    {
+      same = frame && std::ranges::equal(*frame, payload);
+    }
+    return same && size == 4;
+  }();
+  ASSERT_TRUE(cobsr_roundtrip);
+}
@@ -1,5 +1,9 @@
 #include "../src/mameCOBS.hpp"
 #include "utest.h"
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
 #include <ranges>
 #include <vector>
 
@@ -369,7 +373,7 @@ UTEST(decode, error_invalid_code)
     if (!frame_result.has_value())
     {
       found_error = true;
-      ASSERT_EQ(frame_result.error(), decode_error::invalid_cobs);
+      ASSERT_EQ(frame_result.error().kind, decode_error::invalid_cobs);
     }
   }
 
@@ -395,13 +399,31 @@ UTEST(decode, error_oversized_frame)
     if (!frame_result.has_value())
     {
       found_error = true;
-      ASSERT_EQ(frame_result.error(), decode_error::oversized);
+      ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
     }
   }
 
   ASSERT_TRUE(found_error);
 }
 
+UTEST(decode, full_frame_cut_by_delimiter_is_oversized)
+{
+  // 04 00 03 00 fills the 4-byte frame before the last block, which the delimiter then cuts short
+  std::vector<std::byte> input = { std::byte{ 0x02 }, std::byte{ 0x04 }, std::byte{ 0x02 },
+                                   std::byte{ 0x03 }, std::byte{ 0x03 }, std::byte{ 0x00 } };
+
+  for (auto frame_result : input | decode<4>())
+  {
+    ASSERT_FALSE(frame_result.has_value());
+    ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
+  }
+  for (auto frame_result : input | decode<4, no_checksum, null_observer, branch_light_loop>())
+  {
+    ASSERT_FALSE(frame_result.has_value());
+    ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
+  }
+}
+
 UTEST(decode, with_size_limit)
 {
   // Create a frame that would exceed 10 bytes
@@ -419,7 +441,7 @@ UTEST(decode, with_size_limit)
   for (auto frame_result : decoded_frames)
   {
     ASSERT_FALSE(frame_result.has_value());
-    ASSERT_EQ(frame_result.error(), decode_error::oversized);
+    ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
   }
 }
 
@@ -452,4 +474,266 @@ UTEST(decode, error_recovery)
   ASSERT_TRUE(results[1]);                     // Second frame is valid
   ASSERT_EQ(sizes[0], static_cast<size_t>(0)); // Empty frame
   ASSERT_EQ(sizes[1], static_cast<size_t>(2)); // Two bytes
-}
\ No newline at end of file
+}
+
+UTEST(decode, error_reports_offset_frame_index_and_discarded)
+{
+  std::vector<std::byte> encoded = {
+    std::byte{ 0x02 }, std::byte{ 0x11 }, std::byte{ 0x00 }, // Frame 0: [0, 3)
+    std::byte{ 0x05 }, std::byte{ 0x22 }, std::byte{ 0x00 }, // Frame 1: block cut short by the delimiter at 5
+    std::byte{ 0x00 },                                       // Frame 2: empty
+    std::byte{ 0x02 }, std::byte{ 0x33 }, std::byte{ 0x00 }  // Frame 3
+  };
+
+  std::size_t results = 0;
+  std::size_t errors = 0;
+  for (auto frame_result : encoded | decode())
+  {
+    ++results;
+    if (!frame_result)
+    {
+      ++errors;
+      ASSERT_TRUE(frame_result.error() == decode_error::invalid_cobs);
+      ASSERT_EQ(frame_result.error().offset, static_cast<std::uint64_t>(5));
+      ASSERT_EQ(frame_result.error().frame_index, static_cast<std::uint64_t>(1));
+      ASSERT_EQ(frame_result.error().discarded, static_cast<std::uint64_t>(3));
+    }
+  }
+
+  ASSERT_EQ(errors, static_cast<std::size_t>(1));
+  ASSERT_EQ(results, static_cast<std::size_t>(4));
+}
+
+UTEST(decode, error_is_reported_before_the_resync)
+{
+  // An oversized frame is reported where it overflows; the rest of it is skipped on the next ++, on both
+  // input paths
+  std::vector<std::byte> encoded = { std::byte{ 0x02 }, std::byte{ 0x11 }, std::byte{ 0x00 } };
+  encoded.push_back(std::byte{ 20 });
+  for (int i = 0; i < 19; ++i)
+  {
+    encoded.push_back(std::byte{ 0x42 });
+  }
+  encoded.push_back(std::byte{ 0x00 });
+  std::list<std::byte> listed(encoded.begin(), encoded.end());
+
+  auto check = [&](auto &&decoded_frames)
+  {
+    std::size_t errors = 0;
+    for (auto frame_result : decoded_frames)
+    {
+      if (!frame_result)
+      {
+        ++errors;
+        const frame_error &e = frame_result.error();
+        if (e.kind != decode_error::oversized || e.offset != 3 + 1 + 10 || e.frame_index != 1 ||
+            e.discarded != 1 + 10)
+        {
+          return false;
+        }
+      }
+    }
+    return errors == 1;
+  };
+
+  stats_observer::local() = {};
+  ASSERT_TRUE(check(encoded | decode<10, no_checksum, stats_observer>()));
+  ASSERT_EQ(stats_observer::local().resync_bytes, 10u);
+  ASSERT_TRUE(check(listed | decode<10>()));
+}
+
+UTEST(decode, resync_bytes_are_counted_without_an_observer)
+{
+  // The same oversized frame: 10 bytes are skipped once the iterator moves past its error
+  std::vector<std::byte> encoded = { std::byte{ 0x02 }, std::byte{ 0x11 }, std::byte{ 0x00 } };
+  encoded.push_back(std::byte{ 20 });
+  for (int i = 0; i < 19; ++i)
+  {
+    encoded.push_back(std::byte{ 0x42 });
+  }
+  encoded.push_back(std::byte{ 0x00 });
+  std::list<std::byte> listed(encoded.begin(), encoded.end());
+
+  auto check = [](auto &&decoded_frames)
+  {
+    auto it = decoded_frames.begin();
+    ++it;
+    if ((*it).has_value() || it.resync_bytes() != 0)
+    {
+      return false;
+    }
+    ++it;
+    return it == decoded_frames.end() && it.resync_bytes() == 10;
+  };
+
+  ASSERT_TRUE(check(encoded | decode<10>()));
+  ASSERT_TRUE(check(listed | decode<10>()));
+}
+
+UTEST(decode, branch_light_loop_matches_state_machine)
+{
+  // Random frames with zeros and 0xFF bytes, some over the limit, a few corrupted bytes and a cut at the end
+  std::mt19937 gen(47);
+  std::uniform_int_distribution<> value(0, 255);
+  std::uniform_int_distribution<> size(0, 900);
+  std::vector<std::vector<std::byte>> frames(60);
+  for (auto &frame : frames)
+  {
+    frame.resize(static_cast<std::size_t>(size(gen)));
+    for (auto &b : frame)
+    {
+      int v = value(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 40 ? 0 : v) };
+    }
+  }
+  frames.push_back(std::vector<std::byte>(254, std::byte{ 0x11 }));
+
+  auto outcomes = [](auto &&decoded_frames)
+  {
+    std::vector<std::vector<std::uint64_t>> out;
+    for (auto frame_result : decoded_frames)
+    {
+      if (frame_result)
+      {
+        std::vector<std::uint64_t> row = { 1 };
+        for (std::byte b : *frame_result)
+        {
+          row.push_back(std::to_integer<std::uint64_t>(b));
+        }
+        out.push_back(row);
+      }
+      else
+      {
+        const frame_error &e = frame_result.error();
+        out.push_back({ 0, static_cast<std::uint64_t>(e.kind), e.offset, e.frame_index, e.discarded });
+      }
+    }
+    return out;
+  };
+
+  for (std::byte delim : { std::byte{ 0x00 }, std::byte{ 0xFF } })
+  {
+    std::vector<std::byte> encoded;
+    for (auto b : frames | encode(true, delim))
+    {
+      encoded.push_back(b);
+    }
+    for (int i = 0; i < 8; ++i)
+    {
+      encoded[static_cast<std::size_t>(value(gen)) * encoded.size() / 256] = delim;
+    }
+
+    for (std::size_t cut : { std::size_t{ 0 }, std::size_t{ 1 }, std::size_t{ 3 } })
+    {
+      std::vector<std::byte> input(encoded.begin(), encoded.end() - static_cast<std::ptrdiff_t>(cut));
+      std::list<std::byte> listed(input.begin(), input.end());
+      auto expected = outcomes(input | decode<512>(delim));
+      ASSERT_TRUE(
+          outcomes(input | decode<512, no_checksum, null_observer, branch_light_loop>(delim)) == expected
+      );
+      ASSERT_TRUE(
+          outcomes(listed | decode<512, no_checksum, null_observer, branch_light_loop>(delim)) == expected
+      );
+    }
+  }
+
+  std::vector<std::byte> checked;
+  for (auto b : frames | encode<crc32c>())
+  {
+    checked.push_back(b);
+  }
+  ASSERT_TRUE(outcomes(checked | decode<1024, crc32c, null_observer, branch_light_loop>()) ==
+              outcomes(checked | decode<1024, crc32c>()));
+}
+
+UTEST(decode, unchecked_loop_matches_state_machine_on_valid_input)
+{
+  // Well-formed streams only: random frames with zeros and 0xFF bytes, some over the limit, and a cut at
+  // the end
+  std::mt19937 gen(48);
+  std::uniform_int_distribution<> value(0, 255);
+  std::uniform_int_distribution<> size(0, 900);
+  std::vector<std::vector<std::byte>> frames(60);
+  for (auto &frame : frames)
+  {
+    frame.resize(static_cast<std::size_t>(size(gen)));
+    for (auto &b : frame)
+    {
+      int v = value(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 40 ? 0 : v) };
+    }
+  }
+  frames.push_back(std::vector<std::byte>(254, std::byte{ 0x11 }));
+  frames.push_back({});
+
+  // Errors are detected per block in the unchecked loop, so only their kind and index are compared; the
+  // frames after them show that both loops resync at the same delimiter
+  auto outcomes = [](auto &&decoded_frames)
+  {
+    std::vector<std::vector<std::uint64_t>> out;
+    for (auto frame_result : decoded_frames)
+    {
+      if (frame_result)
+      {
+        std::vector<std::uint64_t> row = { 1 };
+        for (std::byte b : *frame_result)
+        {
+          row.push_back(std::to_integer<std::uint64_t>(b));
+        }
+        out.push_back(row);
+      }
+      else
+      {
+        const frame_error &e = frame_result.error();
+        out.push_back({ 0, static_cast<std::uint64_t>(e.kind), e.frame_index });
+      }
+    }
+    return out;
+  };
+
+  for (std::byte delim : { std::byte{ 0x00 }, std::byte{ 0xFF } })
+  {
+    std::vector<std::byte> encoded;
+    for (auto b : frames | encode(true, delim))
+    {
+      encoded.push_back(b);
+    }
+
+    for (std::size_t cut : { std::size_t{ 0 }, std::size_t{ 1 }, std::size_t{ 3 }, std::size_t{ 200 } })
+    {
+      std::vector<std::byte> input(encoded.begin(), encoded.end() - static_cast<std::ptrdiff_t>(cut));
+      std::list<std::byte> listed(input.begin(), input.end());
+      auto expected = outcomes(input | decode<512>(delim));
+      ASSERT_TRUE(outcomes(input | decode_unchecked<512>(delim)) == expected);
+      ASSERT_TRUE(outcomes(listed | decode_unchecked<512>(delim)) == expected);
+    }
+  }
+}
+
+UTEST(decode, unchecked_loop_stays_in_bounds_on_garbage)
+{
+  // Undefined results, but random bytes must neither crash nor yield a frame over the limit
+  std::mt19937 gen(480);
+  std::uniform_int_distribution<> value(0, 255);
+  std::vector<std::byte> garbage(20000);
+  for (auto &b : garbage)
+  {
+    int v = value(gen);
+    b = std::byte{ static_cast<unsigned char>(v < 2 ? 0 : v) };
+  }
+  std::list<std::byte> listed(garbage.begin(), garbage.end());
+
+  auto largest = [](auto &&decoded_frames)
+  {
+    std::size_t size = 0;
+    for (auto frame_result : decoded_frames)
+    {
+      size = frame_result ? std::max(size, frame_result->size()) : size;
+    }
+    return size;
+  };
+
+  ASSERT_LE(largest(garbage | decode_unchecked<64>()), 64u);
+  ASSERT_LE(largest(listed | decode_unchecked<64>()), 64u);
+  ASSERT_LE(largest(garbage | decode_unchecked<1024>()), 1024u);
+}
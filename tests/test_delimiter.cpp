@@ -0,0 +1,179 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <list>
+#include <random>
+#include <ranges>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  template <typename Range>
+  std::vector<std::vector<std::byte>> collect_frames(Range &&range)
+  {
+    std::vector<std::vector<std::byte>> result;
+    for (auto frame_result : range)
+    {
+      if (frame_result.has_value())
+      {
+        result.emplace_back(frame_result->begin(), frame_result->end());
+      }
+    }
+    return result;
+  }
+} // namespace
+
+UTEST(delimiter, encode_with_0x7e)
+{
+  // Plain COBS [0x03, 0x11, 0x22, 0x02, 0x33, 0x00] XOR 0x7E
+  std::vector<std::byte> input = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+  auto result = collect_bytes(input | encode(true, std::byte{ 0x7E }));
+
+  std::vector<std::byte> expected = { std::byte{ 0x7D }, std::byte{ 0x6F }, std::byte{ 0x5C },
+                                      std::byte{ 0x7C }, std::byte{ 0x4D }, std::byte{ 0x7E } };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(delimiter, decode_with_0x7e)
+{
+  std::vector<std::byte> input = { std::byte{ 0x7D }, std::byte{ 0x6F }, std::byte{ 0x5C },
+                                   std::byte{ 0x7C }, std::byte{ 0x4D }, std::byte{ 0x7E } };
+  auto frames = collect_frames(input | decode(std::byte{ 0x7E }));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+  ASSERT_EQ(frames[0].size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(frames[0][i], expected[i]);
+  }
+}
+
+UTEST(delimiter, delimiter_only_between_frames)
+{
+  std::vector<std::byte> original;
+  for (int i = 0; i < 600; ++i)
+  {
+    original.push_back(std::byte{ static_cast<unsigned char>(i * 7) });
+  }
+
+  auto encoded = collect_bytes(original | encode(true, std::byte{ 0x7E }));
+
+  for (size_t i = 0; i + 1 < encoded.size(); ++i)
+  {
+    ASSERT_NE(encoded[i], std::byte{ 0x7E });
+  }
+  ASSERT_EQ(encoded.back(), std::byte{ 0x7E });
+}
+
+UTEST(delimiter, error_recovery_skips_to_custom_delimiter)
+{
+  // A broken frame (code announces more bytes than present) followed by a valid one
+  std::vector<std::byte> input = { std::byte{ 0x7E ^ 0x05 }, std::byte{ 0x11 }, std::byte{ 0x7E },
+                                   std::byte{ 0x7E ^ 0x02 }, std::byte{ 0x42 ^ 0x7E }, std::byte{ 0x7E } };
+
+  std::vector<bool> results;
+  std::vector<std::byte> last;
+  for (auto frame_result : input | decode(std::byte{ 0x7E }))
+  {
+    results.push_back(frame_result.has_value());
+    if (frame_result)
+    {
+      last.assign(frame_result->begin(), frame_result->end());
+    }
+    else
+    {
+      ASSERT_EQ(frame_result.error().kind, decode_error::invalid_cobs);
+    }
+  }
+
+  ASSERT_EQ(results.size(), static_cast<size_t>(2));
+  ASSERT_FALSE(results[0]);
+  ASSERT_TRUE(results[1]);
+  ASSERT_EQ(last.size(), static_cast<size_t>(1));
+  ASSERT_EQ(last[0], std::byte{ 0x42 });
+}
+
+UTEST(delimiter, roundtrip_random_delimiters)
+{
+  // Contiguous and input-only ranges take different paths and must agree
+  std::mt19937 gen(28);
+  std::uniform_int_distribution<> dis(0, 255);
+  std::uniform_int_distribution<> len(0, 800);
+
+  for (int n = 0; n < 100; ++n)
+  {
+    std::byte delim{ static_cast<unsigned char>(dis(gen)) };
+    std::vector<std::byte> original(static_cast<size_t>(len(gen)));
+    for (auto &b : original)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 30 ? 0 : v) };
+    }
+    std::list<std::byte> listed(original.begin(), original.end());
+
+    auto encoded = collect_bytes(original | encode(true, delim));
+    auto encoded_list = collect_bytes(listed | encode(true, delim));
+    ASSERT_EQ(encoded.size(), encoded_list.size());
+    for (size_t i = 0; i < encoded.size(); ++i)
+    {
+      ASSERT_EQ(encoded[i], encoded_list[i]);
+    }
+
+    std::list<std::byte> encoded_stream(encoded.begin(), encoded.end());
+    auto frames = collect_frames(encoded | decode(delim));
+    auto frames_list = collect_frames(encoded_stream | decode(delim));
+    ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+    ASSERT_EQ(frames_list.size(), static_cast<size_t>(1));
+    ASSERT_EQ(frames[0].size(), original.size());
+    ASSERT_EQ(frames_list[0].size(), original.size());
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      ASSERT_EQ(frames[0][i], original[i]);
+      ASSERT_EQ(frames_list[0][i], original[i]);
+    }
+  }
+}
+
+UTEST(delimiter, cobsr_roundtrip)
+{
+  std::vector<std::byte> original = {
+    std::byte{ 0x7E }, std::byte{ 0x00 }, std::byte{ 0x11 }, std::byte{ 0xF0 }
+  };
+
+  auto encoded = collect_bytes(original | encode_cobsr(true, std::byte{ 0x7E }));
+  for (size_t i = 0; i + 1 < encoded.size(); ++i)
+  {
+    ASSERT_NE(encoded[i], std::byte{ 0x7E });
+  }
+
+  auto frames = collect_frames(encoded | decode_cobsr(std::byte{ 0x7E }));
+  ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+  ASSERT_EQ(frames[0].size(), original.size());
+  for (size_t i = 0; i < original.size(); ++i)
+  {
+    ASSERT_EQ(frames[0][i], original[i]);
+  }
+}
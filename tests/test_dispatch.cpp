@@ -0,0 +1,266 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <list>
+#include <random>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  constexpr simd_level all_levels[] = {
+    simd_level::scalar, simd_level::swar, simd_level::sse2, simd_level::avx2, simd_level::avx512
+  };
+
+  std::vector<std::byte> random_bytes(std::size_t size, int zero_percent, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(0, 99);
+    std::uniform_int_distribution<> value(1, 255);
+    std::vector<std::byte> data(size);
+    for (auto &b : data)
+    {
+      b = dis(gen) < zero_percent ? std::byte{ 0 } : std::byte{ static_cast<unsigned char>(value(gen)) };
+    }
+    return data;
+  }
+
+  template <class Adapter>
+  std::vector<std::byte> collect_frames_encoded(
+      const std::vector<std::vector<std::byte>> &frames,
+      Adapter adapter
+  )
+  {
+    std::vector<std::byte> result;
+    for (auto b : frames | adapter)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+} // namespace
+
+UTEST(dispatch, scalar_is_always_registered)
+{
+  const kernels::kernel_table *table = kernels::table_for(simd_level::scalar);
+  ASSERT_TRUE(table != nullptr);
+  ASSERT_TRUE(table->level == simd_level::scalar);
+  ASSERT_TRUE(kernels::select_kernels(simd_level::scalar).level == simd_level::scalar);
+}
+
+UTEST(dispatch, swar_finds_every_position)
+{
+  // A match in each byte lane, with 0x01 / 0x80 neighbours that trip naive haszero variants
+  for (std::size_t pos = 0; pos < 24; ++pos)
+  {
+    std::vector<std::byte> data(24, std::byte{ 0x01 });
+    for (std::size_t i = 0; i < data.size(); i += 2)
+    {
+      data[i] = std::byte{ 0x80 };
+    }
+    data[pos] = std::byte{ 0x00 };
+    ASSERT_EQ(
+        kernels::swar::find_byte(data.data(), data.data() + data.size(), std::byte{ 0 }),
+        data.data() + pos
+    );
+  }
+  ASSERT_TRUE(kernels::table_for(simd_level::swar) != nullptr);
+}
+
+UTEST(dispatch, parse_simd_level)
+{
+  ASSERT_TRUE(kernels::parse_simd_level("scalar") == simd_level::scalar);
+  ASSERT_TRUE(kernels::parse_simd_level("swar") == simd_level::swar);
+  ASSERT_TRUE(kernels::parse_simd_level("sse2") == simd_level::sse2);
+  ASSERT_TRUE(kernels::parse_simd_level("avx2") == simd_level::avx2);
+  ASSERT_TRUE(kernels::parse_simd_level("avx512") == simd_level::avx512);
+  ASSERT_FALSE(kernels::parse_simd_level("neon").has_value());
+}
+
+UTEST(dispatch, selection_respects_limit)
+{
+  for (simd_level limit : all_levels)
+  {
+    ASSERT_TRUE(kernels::select_kernels(limit).level <= limit);
+  }
+  ASSERT_TRUE(active_simd_level() == kernels::active_kernels().level);
+}
+
+UTEST(dispatch, find_byte_matches_scalar)
+{
+  for (simd_level level : all_levels)
+  {
+    const kernels::kernel_table *table = kernels::table_for(level);
+    if (!table)
+    {
+      continue;
+    }
+
+    for (int zero_percent : { 0, 2, 30 })
+    {
+      auto data = random_bytes(300, zero_percent, 37 + static_cast<unsigned>(zero_percent));
+      for (std::size_t first = 0; first < 70; ++first)
+      {
+        for (std::size_t last = first; last <= data.size(); last += 7)
+        {
+          const std::byte *p = data.data();
+          ASSERT_EQ(
+              table->find_byte(p + first, p + last, std::byte{ 0 }),
+              kernels::scalar::find_byte(p + first, p + last, std::byte{ 0 })
+          );
+        }
+      }
+    }
+  }
+}
+
+UTEST(dispatch, copy_xor_matches_scalar)
+{
+  auto data = random_bytes(300, 10, 38);
+  for (simd_level level : all_levels)
+  {
+    const kernels::kernel_table *table = kernels::table_for(level);
+    if (!table)
+    {
+      continue;
+    }
+
+    for (std::byte key : { std::byte{ 0x00 }, std::byte{ 0x7E } })
+    {
+      for (std::size_t n = 0; n <= 200; n += 3)
+      {
+        std::vector<std::byte> expected(n + 8, std::byte{ 0xEE });
+        std::vector<std::byte> actual(n + 8, std::byte{ 0xEE });
+        kernels::scalar::copy_xor(expected.data() + 1, data.data() + 5, n, key);
+        table->copy_xor(actual.data() + 1, data.data() + 5, n, key);
+        ASSERT_TRUE(expected == actual);
+      }
+    }
+  }
+}
+
+UTEST(dispatch, find_all_matches_scalar)
+{
+  for (simd_level level : all_levels)
+  {
+    const kernels::kernel_table *table = kernels::table_for(level);
+    if (!table)
+    {
+      continue;
+    }
+
+    for (int zero_percent : { 0, 5, 100 })
+    {
+      auto data = random_bytes(500, zero_percent, 40 + static_cast<unsigned>(zero_percent));
+      for (std::size_t n : { 0, 1, 63, 64, 500 })
+      {
+        std::vector<std::uint32_t> expected;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          if (data[i] == std::byte{ 0 })
+          {
+            expected.push_back(static_cast<std::uint32_t>(i));
+          }
+        }
+
+        // Room for exactly one window's worth of positions forces many calls on the all-zero input
+        std::vector<std::uint32_t> found;
+        std::array<std::uint32_t, kernels::find_all_window> positions{};
+        std::size_t scanned = 0;
+        while (scanned < n)
+        {
+          kernels::match_run run = table->find_all(
+              data.data() + scanned, n - scanned, std::byte{ 0 }, positions.data(), positions.size()
+          );
+          ASSERT_NE(run.scanned, 0u);
+          for (std::size_t i = 0; i < run.count; ++i)
+          {
+            found.push_back(static_cast<std::uint32_t>(scanned + positions[i]));
+          }
+          scanned += run.scanned;
+        }
+        ASSERT_TRUE(found == expected);
+      }
+    }
+  }
+}
+
+namespace
+{
+  // Decodes through the contiguous path and through the byte-at-a-time path and compares the results
+  template <class Adapter>
+  bool same_on_both_paths(const std::vector<std::byte> &encoded, Adapter adapter)
+  {
+    std::list<std::byte> listed(encoded.begin(), encoded.end());
+    std::vector<std::vector<std::byte>> fast;
+    std::vector<std::vector<std::byte>> slow;
+    std::vector<int> fast_errors;
+    std::vector<int> slow_errors;
+    for (auto frame : encoded | adapter)
+    {
+      fast.emplace_back(
+          frame ? std::vector<std::byte>(frame->begin(), frame->end()) : std::vector<std::byte>{}
+      );
+      fast_errors.push_back(frame ? -1 : static_cast<int>(decode_error(frame.error())));
+    }
+    for (auto frame : listed | adapter)
+    {
+      slow.emplace_back(
+          frame ? std::vector<std::byte>(frame->begin(), frame->end()) : std::vector<std::byte>{}
+      );
+      slow_errors.push_back(frame ? -1 : static_cast<int>(decode_error(frame.error())));
+    }
+    return fast == slow && fast_errors == slow_errors;
+  }
+} // namespace
+
+UTEST(dispatch, crc32c_matches_scalar)
+{
+  auto data = random_bytes(300, 10, 41);
+  for (simd_level level : all_levels)
+  {
+    const kernels::kernel_table *table = kernels::table_for(level);
+    if (!table)
+    {
+      continue;
+    }
+
+    for (std::size_t n = 0; n <= data.size(); n += 7)
+    {
+      ASSERT_EQ(table->crc32c_update(0xFFFFFFFFu, data.data(), n),
+                kernels::scalar::crc32c_update(0xFFFFFFFFu, data.data(), n));
+    }
+  }
+}
+
+UTEST(dispatch, short_block_decoder_matches_byte_path)
+{
+  for (int zero_percent : { 1, 10, 30, 50, 100 })
+  {
+    std::vector<std::vector<std::byte>> frames;
+    for (std::size_t size : { 0, 1, 63, 64, 65, 200, 1000, 3000 })
+    {
+      frames.push_back(random_bytes(size, zero_percent, 39 + static_cast<unsigned>(size)));
+    }
+
+    auto plain = collect_frames_encoded(frames, encode(true));
+    auto delimited = collect_frames_encoded(frames, encode(true, std::byte{ 0x7E }));
+    auto reduced = collect_frames_encoded(frames, encode_cobsr(true));
+    auto checked = collect_frames_encoded(frames, encode<crc32c>(true));
+
+    ASSERT_TRUE(same_on_both_paths(plain, decode<4096>()));
+    ASSERT_TRUE(same_on_both_paths(delimited, decode<4096>(std::byte{ 0x7E })));
+    ASSERT_TRUE(same_on_both_paths(reduced, decode_cobsr<4096>()));
+    ASSERT_TRUE(same_on_both_paths(checked, decode<4096, crc32c>()));
+    ASSERT_TRUE(same_on_both_paths(plain, decode<100>())); // Oversized frames
+
+    // A delimiter planted inside a run of short blocks must still be reported as invalid_cobs
+    for (std::size_t at = 5; at < plain.size(); at += 97)
+    {
+      auto corrupted = plain;
+      corrupted[at] = std::byte{ 0 };
+      ASSERT_TRUE(same_on_both_paths(corrupted, decode<4096>()));
+    }
+  }
+}
@@ -0,0 +1,217 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <cstdint>
+#include <random>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  template <std::size_t N>
+  std::vector<std::array<std::byte, N>> random_frames(std::size_t count, int zero_percent, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(0, 99);
+    std::uniform_int_distribution<> value(1, 255);
+    std::vector<std::array<std::byte, N>> frames(count);
+    for (auto &frame : frames)
+    {
+      for (auto &b : frame)
+      {
+        b = dis(gen) < zero_percent ? std::byte{ 0 } : std::byte{ static_cast<unsigned char>(value(gen)) };
+      }
+    }
+    return frames;
+  }
+
+  // Reference output of the general encoder for the same payloads
+  template <std::size_t N>
+  std::vector<std::byte> reference(const std::vector<std::array<std::byte, N>> &frames,
+                                   bool append_delim = true,
+                                   std::byte delim = frame_delim)
+  {
+    std::vector<std::vector<std::byte>> copies;
+    for (const auto &frame : frames)
+    {
+      copies.emplace_back(frame.begin(), frame.end());
+    }
+    return collect_bytes(copies | encode(append_delim, delim));
+  }
+
+  template <std::size_t N>
+  bool matches_reference()
+  {
+    for (int zero_percent : { 0, 10, 50, 100 })
+    {
+      auto frames = random_frames<N>(
+          5,
+          zero_percent,
+          static_cast<unsigned>(N) * 7 + static_cast<unsigned>(zero_percent)
+      );
+      if (collect_bytes(frames | encode()) != reference(frames))
+      {
+        return false;
+      }
+      if (collect_bytes(frames | encode(false, std::byte{ 0x55 })) !=
+          reference(frames, false, std::byte{ 0x55 }))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  struct telemetry
+  {
+    std::uint32_t id;
+    std::uint16_t flags;
+    std::uint16_t channel;
+    std::int64_t value;
+  };
+
+  // Padding between the members, and a float, whose equal values can differ in their bytes
+  struct padded
+  {
+    std::uint8_t tag;
+    std::uint32_t value;
+  };
+
+  struct with_float
+  {
+    std::uint32_t id;
+    float value;
+  };
+
+  template <class Frame, class Adapter>
+  concept encodable = requires(const Frame &frame, const Adapter &adapter) { frame | adapter; };
+} // namespace
+
+UTEST(fixed, byte_arrays_select_fixed_encoder)
+{
+  std::vector<std::array<std::byte, 32>> arrays;
+  std::vector<std::vector<std::byte>> vectors;
+  std::vector<telemetry> structs;
+  ASSERT_TRUE((std::is_same_v<
+               decltype(arrays | encode()),
+               views::encode_fixed<std::vector<std::array<std::byte, 32>>>>));
+  ASSERT_TRUE((std::is_same_v<decltype(structs | encode()), views::encode_fixed<std::vector<telemetry>>>));
+  ASSERT_TRUE((std::is_same_v<
+               decltype(vectors | encode()),
+               views::encode<std::vector<std::vector<std::byte>>>>));
+  ASSERT_TRUE((std::is_same_v<
+               decltype(arrays | encode_cobsr()),
+               views::encode<std::vector<std::array<std::byte, 32>>, cobs_variant::reduced>>));
+}
+
+UTEST(fixed, matches_general_encoder)
+{
+  ASSERT_TRUE(matches_reference<1>());
+  ASSERT_TRUE(matches_reference<32>());
+  ASSERT_TRUE(matches_reference<64>());
+  ASSERT_TRUE(matches_reference<253>());
+  ASSERT_TRUE(matches_reference<254>());
+  ASSERT_TRUE(matches_reference<255>());
+  ASSERT_TRUE(matches_reference<508>());
+  ASSERT_TRUE(matches_reference<600>());
+}
+
+UTEST(fixed, structs_roundtrip_through_decode_as)
+{
+  std::vector<telemetry> sent = { { 1, 0, 3, 5 }, { 0, 0xFF00, 0, -2 }, { 0x01020304, 7, 256, 1000000000 } };
+  auto encoded = collect_bytes(sent | encode());
+
+  std::size_t i = 0;
+  for (auto msg : encoded | decode_as<telemetry>())
+  {
+    ASSERT_TRUE(msg.has_value());
+    ASSERT_EQ(msg->id, sent[i].id);
+    ASSERT_EQ(msg->channel, sent[i].channel);
+    ASSERT_EQ(msg->value, sent[i].value);
+    ++i;
+  }
+  ASSERT_EQ(i, sent.size());
+}
+
+UTEST(fixed, structs_with_checksum_use_general_encoder)
+{
+  std::vector<telemetry> sent = { { 5, 1, 2, 3 }, { 6, 0, 0, 0 } };
+  auto encoded = collect_bytes(sent | encode<crc32c>());
+
+  std::size_t count = 0;
+  for (auto frame : encoded | decode<4096, crc32c>())
+  {
+    ASSERT_TRUE(frame.has_value());
+    ASSERT_EQ(frame->size(), sizeof(telemetry));
+    ++count;
+  }
+  ASSERT_EQ(count, sent.size());
+}
+
+UTEST(fixed, single_frames_select_fixed_encoder)
+{
+  std::array<std::byte, 32> array{};
+  std::span<const std::byte, 32> span(array);
+  telemetry message{ 1, 2, 3, 4 };
+  ASSERT_TRUE((std::is_same_v<
+               decltype(array | encode()),
+               views::encode_fixed<std::ranges::single_view<std::array<std::byte, 32>>>>));
+  ASSERT_TRUE((std::is_same_v<
+               decltype(span | encode()),
+               views::encode_fixed<std::ranges::single_view<std::span<const std::byte, 32>>>>));
+  ASSERT_TRUE((std::is_same_v<
+               decltype(message | encode()),
+               views::encode_fixed<std::ranges::single_view<telemetry>>>));
+}
+
+UTEST(fixed, single_frames_match_frame_ranges)
+{
+  for (const auto &frame : random_frames<300>(4, 10, 11))
+  {
+    std::vector<std::array<std::byte, 300>> one = { frame };
+    ASSERT_TRUE(collect_bytes(frame | encode()) == reference(one));
+    ASSERT_TRUE(collect_bytes(std::span(frame) | encode()) == reference(one));
+    ASSERT_TRUE(
+        collect_bytes(frame | encode(false, std::byte{ 0x55 })) == reference(one, false, std::byte{ 0x55 })
+    );
+  }
+
+  telemetry message{ 0x01020304, 0, 256, -2 };
+  std::vector<telemetry> messages = { message };
+  ASSERT_TRUE(collect_bytes(message | encode()) == collect_bytes(messages | encode()));
+  ASSERT_TRUE(collect_bytes(message | encode<crc32c>()) == collect_bytes(messages | encode<crc32c>()));
+
+  std::size_t count = 0;
+  for (auto msg : collect_bytes(message | encode()) | decode_as<telemetry>())
+  {
+    ASSERT_TRUE(msg.has_value());
+    ASSERT_EQ(msg->id, message.id);
+    ASSERT_EQ(msg->value, message.value);
+    ++count;
+  }
+  ASSERT_EQ(count, static_cast<std::size_t>(1));
+}
+
+UTEST(fixed, structs_need_unique_object_representations)
+{
+  ASSERT_TRUE((encodable<telemetry, decltype(encode())>));
+  ASSERT_TRUE((encodable<telemetry, decltype(encode<crc32c>())>));
+  ASSERT_FALSE((encodable<padded, decltype(encode())>));
+  ASSERT_FALSE((encodable<with_float, decltype(encode())>));
+  ASSERT_FALSE((encodable<with_float, decltype(encode<crc32c>())>));
+}
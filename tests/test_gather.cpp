@@ -0,0 +1,105 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <list>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  std::vector<std::byte> random_bytes(std::size_t size, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(0, 255);
+    std::vector<std::byte> data(size);
+    for (auto &b : data)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 20 ? 0 : v) };
+    }
+    return data;
+  }
+
+  struct header
+  {
+    std::uint16_t type;
+    std::uint16_t length;
+  };
+} // namespace
+
+UTEST(gather, header_and_payload_as_one_frame)
+{
+  header hdr{ 0x0102, 0x0300 };
+  std::vector<std::byte> payload = { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x22 } };
+
+  std::array<std::span<const std::byte>, 2> segments = { std::as_bytes(std::span{ &hdr, 1 }), payload };
+  auto gathered = collect_bytes(segments | encode_gather());
+
+  std::vector<std::byte> joined(segments[0].begin(), segments[0].end());
+  joined.insert(joined.end(), payload.begin(), payload.end());
+  auto expected = collect_bytes(joined | encode());
+
+  ASSERT_TRUE(gathered == expected);
+}
+
+UTEST(gather, block_state_crosses_segment_boundaries)
+{
+  // Segment sizes around the 254-byte block limit, including empty segments
+  auto data = random_bytes(1200, 40);
+  for (std::size_t split : { 0, 1, 253, 254, 255, 508, 1199, 1200 })
+  {
+    std::vector<std::span<const std::byte>> segments = {
+      std::span{ data }.first(split), std::span<const std::byte>{}, std::span{ data }.subspan(split)
+    };
+    auto expected = collect_bytes(data | encode());
+    ASSERT_TRUE(collect_bytes(segments | encode_gather()) == expected);
+
+    std::list<std::byte> head(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(split));
+    std::list<std::byte> tail(data.begin() + static_cast<std::ptrdiff_t>(split), data.end());
+    std::array<std::list<std::byte>, 2> listed = { head, tail };
+    ASSERT_TRUE(collect_bytes(listed | encode_gather()) == expected);
+  }
+}
+
+UTEST(gather, multiple_frames_and_checksum)
+{
+  auto a = random_bytes(300, 41);
+  auto b = random_bytes(10, 42);
+  std::vector<std::vector<std::span<const std::byte>>> frames = {
+    { std::span{ a }.first(100), std::span{ a }.subspan(100) },
+    {},
+    { std::span{ b } },
+  };
+  std::vector<std::vector<std::byte>> joined = { a, {}, b };
+
+  ASSERT_TRUE(collect_bytes(frames | encode_gather()) == collect_bytes(joined | encode()));
+  ASSERT_TRUE(
+      collect_bytes(frames | encode_gather<crc32c>(false, std::byte{ 0x7E })) ==
+      collect_bytes(joined | encode<crc32c>(false, std::byte{ 0x7E }))
+  );
+
+  auto encoded = collect_bytes(frames | encode_gather());
+  std::size_t decoded = 0;
+  for (auto frame : encoded | decode())
+  {
+    ASSERT_TRUE(frame.has_value());
+    ASSERT_TRUE(std::ranges::equal(*frame, joined[decoded]));
+    ++decoded;
+  }
+  ASSERT_EQ(decoded, joined.size());
+}
@@ -0,0 +1,206 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <cstdint>
+#include <list>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  // Counts events in plain statics so the test can tell hooks apart from codec_stats
+  struct counting_observer
+  {
+    static inline std::size_t encoded_frames = 0;
+    static inline std::size_t decoded_frames = 0;
+    static inline std::size_t errors = 0;
+    static inline std::size_t resyncs = 0;
+
+    void on_frame_encoded(std::size_t, std::size_t) noexcept
+    {
+      ++encoded_frames;
+    }
+
+    void on_frame_decoded(std::size_t, std::size_t) noexcept
+    {
+      ++decoded_frames;
+    }
+
+    void on_decode_error(decode_error, std::size_t) noexcept
+    {
+      ++errors;
+    }
+
+    void on_resync(std::size_t) noexcept
+    {
+      ++resyncs;
+    }
+  };
+} // namespace
+
+UTEST(observer, null_observer_adds_no_state)
+{
+  std::vector<std::vector<std::byte>> frames;
+  using plain = decltype(frames | encode());
+  using observed = decltype(frames | encode<no_checksum, null_observer>());
+  ASSERT_TRUE((std::same_as<plain, observed>));
+  ASSERT_EQ(alignof(codec_stats), static_cast<std::size_t>(64));
+}
+
+UTEST(observer, encode_reports_frames_and_bytes)
+{
+  stats_observer::local() = {};
+
+  std::vector<std::vector<std::byte>> frames = { { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x22 } },
+                                                 {},
+                                                 std::vector<std::byte>(300, std::byte{ 0x5A }) };
+  auto encoded = collect_bytes(frames | encode<no_checksum, stats_observer>(true));
+
+  const codec_stats &s = stats_observer::local();
+  ASSERT_EQ(s.frames_encoded, static_cast<std::uint64_t>(3));
+  ASSERT_EQ(s.encode_bytes_in, static_cast<std::uint64_t>(303));
+  ASSERT_EQ(s.encode_bytes_out, static_cast<std::uint64_t>(encoded.size()));
+  ASSERT_EQ(s.max_frame_size, static_cast<std::uint64_t>(300));
+}
+
+UTEST(observer, encode_counts_slow_path_and_checksum)
+{
+  stats_observer::local() = {};
+
+  std::list<std::byte> payload(600, std::byte{ 0x00 });
+  auto encoded = collect_bytes(payload | encode<crc32c, stats_observer>(false));
+
+  const codec_stats &s = stats_observer::local();
+  ASSERT_EQ(s.frames_encoded, static_cast<std::uint64_t>(1));
+  ASSERT_EQ(s.encode_bytes_in, static_cast<std::uint64_t>(600));
+  ASSERT_EQ(s.encode_bytes_out, static_cast<std::uint64_t>(encoded.size()));
+}
+
+UTEST(observer, decode_reports_frames_errors_and_resync)
+{
+  // Frame "11 22", a block cut short by the delimiter, then frame "33"
+  std::vector<std::byte> stream = {
+    std::byte{ 0x03 }, std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x05 },
+    std::byte{ 0x01 }, std::byte{ 0x00 }, std::byte{ 0x02 }, std::byte{ 0x33 }, std::byte{ 0x00 }
+  };
+  std::list<std::byte> listed(stream.begin(), stream.end());
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    stats_observer::local() = {};
+    std::size_t results = 0;
+    if (pass == 0)
+    {
+      for (auto frame_result : stream | decode<4096, no_checksum, stats_observer>())
+      {
+        (void)frame_result;
+        ++results;
+      }
+    }
+    else
+    {
+      for (auto frame_result : listed | decode<4096, no_checksum, stats_observer>())
+      {
+        (void)frame_result;
+        ++results;
+      }
+    }
+
+    const codec_stats &s = stats_observer::local();
+    ASSERT_EQ(results, static_cast<std::size_t>(3));
+    ASSERT_EQ(s.frames_decoded, static_cast<std::uint64_t>(2));
+    ASSERT_EQ(s.decode_bytes_out, static_cast<std::uint64_t>(3));
+    ASSERT_EQ(
+        s.decode_errors[static_cast<std::size_t>(decode_error::invalid_cobs)],
+        static_cast<std::uint64_t>(1)
+    );
+    ASSERT_EQ(s.decode_bytes_in + s.resync_bytes, static_cast<std::uint64_t>(stream.size()));
+    ASSERT_EQ(s.max_frame_size, static_cast<std::uint64_t>(2));
+  }
+}
+
+UTEST(observer, decode_counts_checksum_mismatch)
+{
+  stats_observer::local() = {};
+
+  std::vector<std::vector<std::byte>> frames = {
+    { std::byte{ 0x11 }, std::byte{ 0x22 } }, { std::byte{ 0x44 } }
+  };
+  auto encoded = collect_bytes(frames | encode<crc32c>(true));
+  encoded[1] ^= std::byte{ 0x01 };
+
+  for (auto frame_result : encoded | decode<4096, crc32c, stats_observer>())
+  {
+    (void)frame_result;
+  }
+
+  const codec_stats &s = stats_observer::local();
+  ASSERT_EQ(s.frames_decoded, static_cast<std::uint64_t>(1));
+  ASSERT_EQ(
+      s.decode_errors[static_cast<std::size_t>(decode_error::checksum_mismatch)],
+      static_cast<std::uint64_t>(1)
+  );
+  ASSERT_EQ(s.decode_bytes_in, static_cast<std::uint64_t>(encoded.size()));
+  ASSERT_EQ(s.resync_bytes, static_cast<std::uint64_t>(0));
+}
+
+UTEST(observer, custom_observer_hooks)
+{
+  counting_observer::encoded_frames = 0;
+  counting_observer::decoded_frames = 0;
+  counting_observer::errors = 0;
+  counting_observer::resyncs = 0;
+
+  std::vector<std::vector<std::byte>> frames = { { std::byte{ 0x01 } }, { std::byte{ 0x02 } } };
+  auto encoded = collect_bytes(frames | encode_cobsr<no_checksum, counting_observer>(true));
+  encoded.push_back(std::byte{ 0x05 }); // Truncated trailing frame
+
+  for (auto frame_result : encoded | decode_cobsr<4096, no_checksum, counting_observer>())
+  {
+    (void)frame_result;
+  }
+
+  ASSERT_EQ(counting_observer::encoded_frames, static_cast<std::size_t>(2));
+  ASSERT_EQ(counting_observer::decoded_frames, static_cast<std::size_t>(2));
+  ASSERT_EQ(counting_observer::errors, static_cast<std::size_t>(1));
+  ASSERT_EQ(counting_observer::resyncs, static_cast<std::size_t>(1));
+}
+
+UTEST(observer, stats_are_per_thread)
+{
+  stats_observer::local() = {};
+
+  codec_stats worker_stats;
+  std::thread worker(
+      [&worker_stats]
+      {
+        std::vector<std::byte> payload(10, std::byte{ 0x01 });
+        for (auto b : payload | encode<no_checksum, stats_observer>())
+        {
+          (void)b;
+        }
+        worker_stats = stats_observer::local();
+      }
+  );
+  worker.join();
+
+  ASSERT_EQ(worker_stats.frames_encoded, static_cast<std::uint64_t>(1));
+  ASSERT_EQ(stats_observer::local().frames_encoded, static_cast<std::uint64_t>(0));
+
+  codec_stats total = stats_observer::local();
+  total += worker_stats;
+  ASSERT_EQ(total.encode_bytes_in, static_cast<std::uint64_t>(10));
+}
@@ -0,0 +1,151 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <cstdint>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  struct outcome
+  {
+    bool ok;
+    std::vector<std::byte> frame;
+    decode_error kind = decode_error::incomplete;
+
+    bool operator==(const outcome &other) const = default;
+  };
+
+  // Random frames, some longer than 512 bytes, with a few bytes corrupted into delimiters
+  std::vector<std::byte> mixed_stream(unsigned seed, std::byte delim)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> value(0, 255);
+    std::uniform_int_distribution<> size(0, 700);
+    std::vector<std::vector<std::byte>> frames(40);
+    for (auto &frame : frames)
+    {
+      frame.resize(static_cast<std::size_t>(size(gen)));
+      for (auto &b : frame)
+      {
+        int v = value(gen);
+        b = std::byte{ static_cast<unsigned char>(v < 30 ? 0 : v) };
+      }
+    }
+    auto encoded = collect_bytes(frames | encode(true, delim));
+    for (int i = 0; i < 6; ++i)
+    {
+      encoded[static_cast<std::size_t>(value(gen)) * encoded.size() / 256] = delim;
+    }
+    return encoded;
+  }
+} // namespace
+
+UTEST(push, matches_decode)
+{
+  for (std::byte delim : { std::byte{ 0x00 }, std::byte{ 0x7E } })
+  {
+    auto encoded = mixed_stream(21, delim);
+
+    std::vector<outcome> expected;
+    for (auto result : encoded | decode<512>(delim))
+    {
+      if (result)
+      {
+        expected.push_back({ true, { result->begin(), result->end() } });
+      }
+      else
+      {
+        expected.push_back({ false, {}, result.error().kind });
+      }
+    }
+
+    std::array<std::byte, 512> buffer;
+    byte_decoder decoder(buffer, delim);
+    std::vector<outcome> pushed;
+    for (std::byte b : encoded)
+    {
+      switch (decoder.push_byte(b))
+      {
+      case push_status::frame_complete:
+        pushed.push_back({ true, { decoder.frame().begin(), decoder.frame().end() } });
+        break;
+      case push_status::error:
+        pushed.push_back({ false, {}, decoder.error() });
+        break;
+      case push_status::need_more:
+        break;
+      }
+    }
+    ASSERT_TRUE(pushed == expected);
+  }
+}
+
+UTEST(push, oversized_frame_is_dropped_until_delimiter)
+{
+  std::array<std::byte, 2> buffer;
+  byte_decoder decoder(buffer);
+
+  // 04 11 22 33 00 | 02 44 00
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x04 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x11 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x22 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x33 }) == push_status::error);
+  ASSERT_EQ(decoder.error(), decode_error::oversized);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x00 }) == push_status::need_more);
+
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x02 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x44 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x00 }) == push_status::frame_complete);
+  ASSERT_EQ(decoder.frame().size(), 1u);
+  ASSERT_TRUE(decoder.frame()[0] == std::byte{ 0x44 });
+}
+
+UTEST(push, full_buffer_cut_by_delimiter_is_oversized)
+{
+  std::array<std::byte, 4> buffer;
+  byte_decoder decoder(buffer);
+
+  // 02 04 02 03 03 00: 04 00 03 00 fills the buffer, then the delimiter cuts the last block short
+  for (std::byte b :
+       { std::byte{ 0x02 }, std::byte{ 0x04 }, std::byte{ 0x02 }, std::byte{ 0x03 }, std::byte{ 0x03 } })
+  {
+    ASSERT_TRUE(decoder.push_byte(b) == push_status::need_more);
+  }
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x00 }) == push_status::error);
+  ASSERT_EQ(decoder.error(), decode_error::oversized);
+
+  // The delimiter closed the failed frame, so the next one decodes
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x02 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x44 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x00 }) == push_status::frame_complete);
+  ASSERT_EQ(decoder.frame().size(), 1u);
+}
+
+UTEST(push, reset_drops_partial_frame)
+{
+  std::array<std::byte, 16> buffer;
+  byte_decoder decoder(buffer);
+  decoder.push_byte(std::byte{ 0x05 });
+  decoder.push_byte(std::byte{ 0x11 });
+  decoder.reset();
+
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x01 }) == push_status::need_more);
+  ASSERT_TRUE(decoder.push_byte(std::byte{ 0x00 }) == push_status::frame_complete);
+  ASSERT_EQ(decoder.frame().size(), 0u);
+}
@@ -0,0 +1,306 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <list>
+#include <random>
+#include <ranges>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  template <typename Range>
+  std::vector<std::vector<std::byte>> collect_frames(Range &&range)
+  {
+    std::vector<std::vector<std::byte>> result;
+    for (auto frame_result : range)
+    {
+      if (frame_result.has_value())
+      {
+        result.emplace_back(frame_result->begin(), frame_result->end());
+      }
+    }
+    return result;
+  }
+
+  // Single-pass byte source that counts how many bytes have been pulled
+  struct counting_source
+  {
+    const std::vector<std::byte> *data;
+    std::size_t *pulled;
+
+    struct iterator
+    {
+      using value_type = std::byte;
+      using difference_type = std::ptrdiff_t;
+
+      const std::vector<std::byte> *data;
+      std::size_t *pulled;
+      std::size_t pos;
+
+      std::byte operator*() const
+      {
+        return (*data)[pos];
+      }
+      iterator &operator++()
+      {
+        ++pos;
+        *pulled = pos;
+        return *this;
+      }
+      void operator++(int)
+      {
+        ++*this;
+      }
+      friend bool operator==(const iterator &it, std::default_sentinel_t)
+      {
+        return it.pos == it.data->size();
+      }
+    };
+
+    iterator begin() const
+    {
+      return iterator{ data, pulled, 0 };
+    }
+    std::default_sentinel_t end() const
+    {
+      return {};
+    }
+  };
+} // namespace
+
+UTEST(rcobs, encode_code_after_block)
+{
+  // [0x11, 0x22, 0x00, 0x33] -> [0x11, 0x22, 0x03, 0x33, 0x02, 0x00]
+  std::vector<std::byte> input = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+  auto result = collect_bytes(input | encode_rcobs(true));
+
+  std::vector<std::byte> expected = { std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x03 },
+                                      std::byte{ 0x33 }, std::byte{ 0x02 }, std::byte{ 0x00 } };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(rcobs, encode_empty_and_zero_frames)
+{
+  std::vector<std::vector<std::byte>> frames = { {}, { std::byte{ 0x00 } } };
+  auto result = collect_bytes(frames | encode_rcobs(true));
+
+  // [] -> [0x01], [0x00] -> [0x01, 0x01]
+  std::vector<std::byte> expected = {
+    std::byte{ 0x01 }, std::byte{ 0x00 }, std::byte{ 0x01 }, std::byte{ 0x01 }, std::byte{ 0x00 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(rcobs, first_byte_without_lookahead)
+{
+  // The first encoded byte is available after a single input byte has been read
+  std::vector<std::byte> payload(1000, std::byte{ 0x5A });
+  std::size_t pulled = 0;
+  counting_source source{ &payload, &pulled };
+
+  auto encoded = source | encode_rcobs(true);
+  auto it = encoded.begin();
+  ASSERT_EQ(*it, std::byte{ 0x5A });
+  ASSERT_LE(pulled, static_cast<size_t>(1));
+}
+
+UTEST(rcobs, decode_from_end)
+{
+  std::vector<std::byte> input = { std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x03 },
+                                   std::byte{ 0x33 }, std::byte{ 0x02 }, std::byte{ 0x00 } };
+  auto frames = collect_frames(input | decode_rcobs());
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+  ASSERT_EQ(frames[0].size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(frames[0][i], expected[i]);
+  }
+}
+
+UTEST(rcobs, decode_errors_and_recovery)
+{
+  // Code 0x05 claims four bytes but only one precedes it; then an incomplete tail
+  std::vector<std::byte> input = { std::byte{ 0x11 }, std::byte{ 0x05 }, std::byte{ 0x00 },
+                                   std::byte{ 0x42 }, std::byte{ 0x02 }, std::byte{ 0x00 },
+                                   std::byte{ 0x42 } };
+
+  std::vector<decode_error> errors;
+  std::size_t good = 0;
+  for (auto frame_result : input | decode_rcobs())
+  {
+    if (frame_result)
+    {
+      ++good;
+      ASSERT_EQ(frame_result->size(), static_cast<size_t>(1));
+    }
+    else
+    {
+      errors.push_back(frame_result.error());
+    }
+  }
+
+  ASSERT_EQ(good, static_cast<size_t>(1));
+  ASSERT_EQ(errors.size(), static_cast<size_t>(2));
+  ASSERT_EQ(errors[0], decode_error::invalid_cobs);
+  ASSERT_EQ(errors[1], decode_error::incomplete);
+}
+
+UTEST(rcobs, errors_report_offset_frame_index_and_discarded)
+{
+  // Unstuffing fails on the delimiter at offset 2; the input ends inside the third frame
+  std::vector<std::byte> input = { std::byte{ 0x11 }, std::byte{ 0x05 }, std::byte{ 0x00 },
+                                   std::byte{ 0x42 }, std::byte{ 0x02 }, std::byte{ 0x00 },
+                                   std::byte{ 0x42 } };
+
+  std::vector<frame_error> errors;
+  for (auto frame_result : input | decode_rcobs())
+  {
+    if (!frame_result)
+    {
+      errors.push_back(frame_result.error());
+    }
+  }
+
+  ASSERT_EQ(errors.size(), static_cast<size_t>(2));
+  ASSERT_EQ(errors[0].offset, static_cast<std::uint64_t>(2));
+  ASSERT_EQ(errors[0].frame_index, static_cast<std::uint64_t>(0));
+  ASSERT_EQ(errors[0].discarded, static_cast<std::uint64_t>(3));
+  ASSERT_EQ(errors[1].kind, decode_error::incomplete);
+  ASSERT_EQ(errors[1].offset, static_cast<std::uint64_t>(7));
+  ASSERT_EQ(errors[1].frame_index, static_cast<std::uint64_t>(2));
+  ASSERT_EQ(errors[1].discarded, static_cast<std::uint64_t>(1));
+}
+
+UTEST(rcobs, decode_oversized)
+{
+  std::vector<std::byte> original(64, std::byte{ 0x42 });
+  auto encoded = collect_bytes(original | encode_rcobs(true));
+  encoded.push_back(std::byte{ 0x42 });
+  encoded.push_back(std::byte{ 0x02 });
+  encoded.push_back(std::byte{ 0x00 });
+
+  std::vector<bool> results;
+  for (auto frame_result : encoded | decode_rcobs<16>())
+  {
+    results.push_back(frame_result.has_value());
+    if (!frame_result)
+    {
+      ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
+    }
+  }
+
+  ASSERT_EQ(results.size(), static_cast<size_t>(2));
+  ASSERT_FALSE(results[0]);
+  ASSERT_TRUE(results[1]);
+}
+
+UTEST(rcobs, resync_bytes_count_the_rest_of_an_oversized_frame)
+{
+  std::vector<std::byte> original(64, std::byte{ 0x42 });
+  auto encoded = collect_bytes(original | encode_rcobs(true));
+  std::size_t frame_bytes = encoded.size();
+  encoded.push_back(std::byte{ 0x42 });
+  encoded.push_back(std::byte{ 0x02 });
+  encoded.push_back(std::byte{ 0x00 });
+
+  auto decoded = encoded | decode_rcobs<16>();
+  auto it = decoded.begin();
+  ASSERT_FALSE((*it).has_value());
+  std::uint64_t discarded = (*it).error().discarded;
+  ASSERT_EQ(it.resync_bytes(), static_cast<std::uint64_t>(0));
+
+  ++it;
+  ASSERT_TRUE((*it).has_value());
+  ASSERT_EQ(discarded + it.resync_bytes(), static_cast<std::uint64_t>(frame_bytes));
+}
+
+UTEST(rcobs, roundtrip_random_frames)
+{
+  std::mt19937 gen(29);
+  std::uniform_int_distribution<> dis(0, 255);
+  std::uniform_int_distribution<> len(0, 1200);
+
+  for (int n = 0; n < 100; ++n)
+  {
+    std::vector<std::vector<std::byte>> frames(3);
+    for (auto &frame : frames)
+    {
+      frame.resize(static_cast<size_t>(len(gen)));
+      for (auto &b : frame)
+      {
+        int v = dis(gen);
+        b = std::byte{ static_cast<unsigned char>(v < n ? 0 : v) };
+      }
+    }
+
+    auto encoded = collect_bytes(frames | encode_rcobs(true));
+    std::list<std::byte> encoded_stream(encoded.begin(), encoded.end());
+    auto decoded = collect_frames(encoded | decode_rcobs());
+    auto decoded_list = collect_frames(encoded_stream | decode_rcobs());
+
+    ASSERT_EQ(decoded.size(), frames.size());
+    ASSERT_EQ(decoded_list.size(), frames.size());
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      ASSERT_EQ(decoded[i].size(), frames[i].size());
+      ASSERT_EQ(decoded_list[i].size(), frames[i].size());
+      for (size_t j = 0; j < frames[i].size(); ++j)
+      {
+        ASSERT_EQ(decoded[i][j], frames[i][j]);
+        ASSERT_EQ(decoded_list[i][j], frames[i][j]);
+      }
+    }
+  }
+}
+
+UTEST(rcobs, roundtrip_254_byte_boundary)
+{
+  for (size_t size : { 253, 254, 255, 508, 509 })
+  {
+    std::vector<std::byte> original(size, std::byte{ 0x7F });
+    std::list<std::byte> listed(original.begin(), original.end());
+
+    auto encoded = collect_bytes(original | encode_rcobs(true));
+    auto encoded_list = collect_bytes(listed | encode_rcobs(true));
+    ASSERT_EQ(encoded.size(), encoded_list.size());
+
+    // MaxFrameSize exactly equal to the frame size must still decode
+    auto decoded = collect_frames(encoded | decode_rcobs<509>());
+    ASSERT_EQ(decoded.size(), static_cast<size_t>(1));
+    ASSERT_EQ(decoded[0].size(), original.size());
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      ASSERT_EQ(encoded[i], encoded_list[i]);
+      ASSERT_EQ(decoded[0][i], original[i]);
+    }
+  }
+}
@@ -0,0 +1,218 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  std::vector<std::byte> random_bytes(std::size_t size, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(0, 255);
+    std::vector<std::byte> data(size);
+    for (auto &b : data)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 20 ? 0 : v) };
+    }
+    return data;
+  }
+
+  struct header
+  {
+    std::uint16_t type;
+    std::uint16_t length;
+    std::uint32_t sequence;
+  };
+} // namespace
+
+UTEST(scatter, header_then_payload)
+{
+  header h{ 7, 300, 0x01000200 };
+  std::vector<std::byte> payload = random_bytes(300, 1);
+  std::vector<std::byte> frame(sizeof(header));
+  std::memcpy(frame.data(), &h, sizeof(header));
+  frame.insert(frame.end(), payload.begin(), payload.end());
+
+  std::vector<std::vector<std::byte>> frames = { frame };
+  auto encoded = collect_bytes(frames | encode());
+
+  header rx{};
+  std::vector<std::byte> rx_payload(512);
+  std::vector<std::size_t> offsets;
+  auto provider = [&](std::size_t offset) -> std::span<std::byte> {
+    offsets.push_back(offset);
+    if (offset == 0)
+    {
+      return { reinterpret_cast<std::byte *>(&rx), sizeof(rx) };
+    }
+    return std::span(rx_payload).first(offset == sizeof(header) ? rx_payload.size() : 0);
+  };
+
+  std::size_t count = 0;
+  for (auto result : encoded | decode_into(provider))
+  {
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(*result, frame.size());
+    ++count;
+  }
+  ASSERT_EQ(count, 1u);
+  ASSERT_EQ(offsets.size(), 2u);
+  ASSERT_EQ(offsets[1], sizeof(header));
+  ASSERT_EQ(rx.type, h.type);
+  ASSERT_EQ(rx.length, h.length);
+  ASSERT_EQ(rx.sequence, h.sequence);
+  ASSERT_EQ(std::memcmp(rx_payload.data(), payload.data(), payload.size()), 0);
+}
+
+UTEST(scatter, matches_decode_for_contiguous_and_list_input)
+{
+  std::vector<std::vector<std::byte>> frames;
+  for (std::size_t size : { 0u, 1u, 16u, 253u, 254u, 255u, 600u, 2000u })
+  {
+    frames.push_back(random_bytes(size, static_cast<unsigned>(size) + 3));
+  }
+  auto encoded = collect_bytes(frames | encode());
+  std::list<std::byte> encoded_list(encoded.begin(), encoded.end());
+
+  // Small windows force the provider to be asked repeatedly inside each frame
+  auto run = [&](auto &&input) -> std::vector<std::vector<std::byte>> {
+    std::vector<std::vector<std::byte>> out;
+    std::array<std::byte, 7> window{};
+    std::vector<std::byte> current;
+    auto provider = [&](std::size_t offset) -> std::span<std::byte> {
+      if (offset == 0)
+      {
+        current.clear();
+      }
+      current.insert(current.end(), window.begin(), window.end());
+      return std::span(current).subspan(offset);
+    };
+    for (auto result : input | decode_into(provider))
+    {
+      if (!result)
+      {
+        return {};
+      }
+      out.emplace_back(current.begin(), current.begin() + static_cast<std::ptrdiff_t>(*result));
+    }
+    return out;
+  };
+
+  ASSERT_TRUE(run(encoded) == frames);
+  ASSERT_TRUE(run(encoded_list) == frames);
+}
+
+UTEST(scatter, provider_out_of_space_is_oversized_and_resyncs)
+{
+  std::vector<std::vector<std::byte>> frames = { random_bytes(40, 5), random_bytes(10, 6) };
+  auto encoded = collect_bytes(frames | encode());
+
+  std::array<std::byte, 16> buffer{};
+  auto provider = [&](std::size_t offset) -> std::span<std::byte> {
+    return offset == 0 ? std::span<std::byte>(buffer) : std::span<std::byte>{};
+  };
+
+  std::vector<std::expected<std::size_t, frame_error>> results;
+  for (auto result : encoded | decode_into(provider))
+  {
+    results.push_back(result);
+  }
+
+  ASSERT_EQ(results.size(), 2u);
+  ASSERT_FALSE(results[0].has_value());
+  ASSERT_EQ(results[0].error().kind, decode_error::oversized);
+  ASSERT_EQ(results[0].error().frame_index, 0u);
+  ASSERT_TRUE(results[1].has_value());
+  ASSERT_EQ(*results[1], 10u);
+  ASSERT_EQ(std::memcmp(buffer.data(), frames[1].data(), 10), 0);
+}
+
+UTEST(scatter, custom_delimiter)
+{
+  std::vector<std::vector<std::byte>> frames = { random_bytes(300, 9) };
+  auto encoded = collect_bytes(frames | encode(true, std::byte{ 0xAA }));
+
+  std::vector<std::byte> out(300);
+  std::size_t size = 0;
+  for (auto result : encoded | decode_into([&](std::size_t offset) { return std::span(out).subspan(offset); },
+                                           std::byte{ 0xAA }))
+  {
+    ASSERT_TRUE(result.has_value());
+    size = *result;
+  }
+  ASSERT_EQ(size, 300u);
+  ASSERT_TRUE(out == frames[0]);
+}
+
+UTEST(scatter, checksum_and_observer)
+{
+  std::vector<std::vector<std::byte>> frames = { random_bytes(100, 10), {}, random_bytes(700, 11) };
+  auto encoded = collect_bytes(frames | encode<crc32c>());
+  encoded[50] ^= std::byte{ 0x01 }; // Corrupts the payload of the first frame
+
+  // The trailer lands in the provider's memory, so each frame gets room for it
+  std::vector<std::byte> out;
+  auto provider = [&](std::size_t offset) -> std::span<std::byte> {
+    out.assign(offset + 1024, std::byte{ 0 });
+    return std::span(out).subspan(offset);
+  };
+
+  stats_observer::local() = {};
+  std::vector<std::expected<std::size_t, frame_error>> results;
+  for (auto result : encoded | decode_into<crc32c, stats_observer>(provider))
+  {
+    results.push_back(result);
+  }
+
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_FALSE(results[0].has_value());
+  ASSERT_EQ(results[0].error().kind, decode_error::checksum_mismatch);
+  ASSERT_EQ(*results[1], 0u);
+  ASSERT_EQ(*results[2], 700u);
+  ASSERT_TRUE(std::equal(frames[2].begin(), frames[2].end(), out.begin()));
+
+  const codec_stats &s = stats_observer::local();
+  ASSERT_EQ(s.frames_decoded, 2u);
+  ASSERT_EQ(s.decode_errors[static_cast<std::size_t>(decode_error::checksum_mismatch)], 1u);
+  ASSERT_EQ(s.decode_bytes_out, 700u);
+}
+
+UTEST(scatter, empty_frame_never_calls_the_provider)
+{
+  std::vector<std::vector<std::byte>> frames = { {}, {} };
+  auto encoded = collect_bytes(frames | encode());
+
+  std::size_t calls = 0;
+  auto provider = [&](std::size_t) -> std::span<std::byte> {
+    ++calls;
+    return {};
+  };
+  std::size_t count = 0;
+  for (auto result : encoded | decode_into(provider))
+  {
+    ASSERT_EQ(*result, 0u);
+    ++count;
+  }
+  ASSERT_EQ(count, 2u);
+  ASSERT_EQ(calls, 0u);
+}
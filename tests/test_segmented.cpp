@@ -0,0 +1,231 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  std::vector<std::byte> random_bytes(std::size_t size, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(0, 255);
+    std::vector<std::byte> data(size);
+    for (auto &b : data)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < 20 ? 0 : v) };
+    }
+    return data;
+  }
+
+  // Reassembles frames from the events and checks they arrive as begin, data..., end
+  struct recording_sink
+  {
+    std::size_t max_segment = 0;
+    bool open = false;
+    bool out_of_order = false;
+    std::vector<std::byte> current;
+    std::vector<std::vector<std::byte>> frames;
+    std::vector<std::expected<std::uint64_t, frame_error>> results;
+
+    void begin_frame()
+    {
+      out_of_order = out_of_order || open;
+      open = true;
+      current.clear();
+    }
+
+    void data(std::span<const std::byte> segment)
+    {
+      out_of_order = out_of_order || !open || segment.empty();
+      max_segment = std::max(max_segment, segment.size());
+      current.insert(current.end(), segment.begin(), segment.end());
+    }
+
+    void end_frame(const std::expected<std::uint64_t, frame_error> &result)
+    {
+      out_of_order = out_of_order || !open;
+      open = false;
+      results.push_back(result);
+      if (result)
+      {
+        out_of_order = out_of_order || *result != current.size();
+        frames.push_back(current);
+      }
+    }
+  };
+
+  // Keeps a running checksum only, like a sink writing a firmware image to disk
+  struct checksum_sink
+  {
+    crc32c crc;
+    std::uint64_t bytes = 0;
+
+    void begin_frame()
+    {
+      crc = crc32c{};
+      bytes = 0;
+    }
+
+    void data(std::span<const std::byte> segment)
+    {
+      crc.update(segment.data(), segment.size());
+      bytes += segment.size();
+    }
+
+    void end_frame(const std::expected<std::uint64_t, frame_error> &)
+    {
+    }
+  };
+} // namespace
+
+UTEST(segmented, frames_arrive_in_bounded_segments)
+{
+  std::vector<std::vector<std::byte>> frames;
+  for (std::size_t size : { 0u, 1u, 254u, 4095u, 4096u, 4097u, 100000u })
+  {
+    frames.push_back(random_bytes(size, static_cast<unsigned>(size) + 50));
+  }
+  auto encoded = collect_bytes(frames | encode());
+  std::list<std::byte> encoded_list(encoded.begin(), encoded.end());
+
+  recording_sink sink;
+  std::size_t count = 0;
+  for (auto result : encoded | decode_segmented(sink))
+  {
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(*result, frames[count].size());
+    ++count;
+  }
+  ASSERT_EQ(count, frames.size());
+  ASSERT_FALSE(sink.out_of_order);
+  ASSERT_EQ(sink.max_segment, 4096u);
+  ASSERT_TRUE(sink.frames == frames);
+
+  recording_sink small;
+  for ([[maybe_unused]] auto result : encoded_list | decode_segmented<7>(small, frame_delim))
+  {
+  }
+  ASSERT_FALSE(small.out_of_order);
+  ASSERT_EQ(small.max_segment, 7u);
+  ASSERT_TRUE(small.frames == frames);
+}
+
+UTEST(segmented, frame_larger_than_any_buffer)
+{
+  std::vector<std::vector<std::byte>> frames = {
+    random_bytes(std::size_t{ 8 } << 20, 51),
+    random_bytes(10, 52),
+  };
+  auto encoded = collect_bytes(frames | encode(true, std::byte{ 0x7E }));
+
+  crc32c expected;
+  expected.update(frames[0].data(), frames[0].size());
+
+  checksum_sink sink;
+  auto results = encoded | decode_segmented<256>(sink, std::byte{ 0x7E });
+  auto it = results.begin();
+  ASSERT_TRUE((*it).has_value());
+  ASSERT_EQ(**it, frames[0].size());
+  ASSERT_EQ(sink.bytes, frames[0].size());
+  ASSERT_TRUE(sink.crc.digest() == expected.digest());
+  ++it;
+  ASSERT_EQ(**it, 10u);
+  ++it;
+  ASSERT_TRUE(it == std::default_sentinel);
+}
+
+UTEST(segmented, errors_close_the_frame_and_resync)
+{
+  std::vector<std::vector<std::byte>> frames;
+  for (unsigned i = 0; i < 40; ++i)
+  {
+    frames.push_back(random_bytes(300 + i * 37, 60 + i));
+  }
+  auto encoded = collect_bytes(frames | encode());
+  std::mt19937 gen(61);
+  std::uniform_int_distribution<std::size_t> at(0, encoded.size() - 1);
+  for (int i = 0; i < 10; ++i)
+  {
+    encoded[at(gen)] = std::byte{ 0 };
+  }
+
+  // Everything fits decode<4096>, so both decoders must agree frame by frame
+  std::vector<std::expected<std::uint64_t, frame_error>> expected;
+  for (auto frame : encoded | decode<4096>())
+  {
+    if (frame)
+    {
+      expected.push_back(frame->size());
+    }
+    else
+    {
+      expected.push_back(std::unexpected(frame.error()));
+    }
+  }
+
+  recording_sink sink;
+  std::vector<std::expected<std::uint64_t, frame_error>> yielded;
+  for (auto result : encoded | decode_segmented<64>(sink))
+  {
+    yielded.push_back(result);
+  }
+
+  ASSERT_FALSE(sink.open);
+  ASSERT_EQ(yielded.size(), expected.size());
+  ASSERT_EQ(sink.results.size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(yielded[i].has_value(), expected[i].has_value());
+    ASSERT_EQ(sink.results[i].has_value(), expected[i].has_value());
+    if (expected[i])
+    {
+      ASSERT_EQ(*yielded[i], *expected[i]);
+    }
+    else
+    {
+      ASSERT_EQ(yielded[i].error().kind, expected[i].error().kind);
+      ASSERT_EQ(yielded[i].error().offset, expected[i].error().offset);
+      ASSERT_EQ(yielded[i].error().discarded, expected[i].error().discarded);
+      ASSERT_EQ(sink.results[i].error().frame_index, expected[i].error().frame_index);
+    }
+  }
+}
+
+UTEST(segmented, input_ending_inside_a_frame_is_incomplete)
+{
+  // Cut right after a full 254-byte block, where no implicit zero is pending
+  std::vector<std::vector<std::byte>> frames = { std::vector<std::byte>(300, std::byte{ 0x11 }) };
+  auto encoded = collect_bytes(frames | encode(false));
+  std::vector<std::byte> cut(encoded.begin(), encoded.begin() + 255);
+
+  recording_sink sink;
+  std::vector<std::expected<std::uint64_t, frame_error>> yielded;
+  for (auto result : cut | decode_segmented(sink))
+  {
+    yielded.push_back(result);
+  }
+  ASSERT_EQ(yielded.size(), 1u);
+  ASSERT_FALSE(yielded[0].has_value());
+  ASSERT_EQ(yielded[0].error().kind, decode_error::incomplete);
+  ASSERT_FALSE(sink.open);
+  ASSERT_EQ(sink.results.size(), 1u);
+}
@@ -0,0 +1,179 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <cstdint>
+#include <list>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  struct outcome
+  {
+    bool ok;
+    std::vector<std::byte> frame;
+    frame_error error{ decode_error::incomplete };
+
+    bool operator==(const outcome &other) const
+    {
+      return ok == other.ok && frame == other.frame && error.kind == other.error.kind &&
+             error.offset == other.error.offset && error.frame_index == other.error.frame_index &&
+             error.discarded == other.error.discarded;
+    }
+  };
+
+  // Frames of random sizes with zeros, plus oversized, truncated and corrupted frames
+  std::vector<std::byte> mixed_stream(unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> value(0, 255);
+    std::uniform_int_distribution<> size(0, 700);
+    std::vector<std::vector<std::byte>> frames(40);
+    for (auto &frame : frames)
+    {
+      frame.resize(static_cast<std::size_t>(size(gen)));
+      for (auto &b : frame)
+      {
+        int v = value(gen);
+        b = std::byte{ static_cast<unsigned char>(v < 30 ? 0 : v) };
+      }
+    }
+    auto encoded = collect_bytes(frames | encode());
+    // Corrupt a few code and data bytes into delimiters
+    for (int i = 0; i < 6; ++i)
+    {
+      encoded[static_cast<std::size_t>(value(gen)) * encoded.size() / 256] = std::byte{ 0 };
+    }
+    encoded.resize(encoded.size() - 3); // Truncated last frame
+    return encoded;
+  }
+
+  template <class Input>
+  std::vector<outcome> with_views(const Input &input)
+  {
+    std::vector<outcome> out;
+    for (auto result : input | decode<512>())
+    {
+      if (result)
+      {
+        out.push_back({ true, { result->begin(), result->end() } });
+      }
+      else
+      {
+        out.push_back({ false, {}, result.error() });
+      }
+    }
+    return out;
+  }
+
+  template <class Input>
+  std::vector<outcome> with_steps(const Input &input, std::size_t budget, bool &within_budget)
+  {
+    std::vector<outcome> out;
+    auto decoder = decode_stepwise<512>(input);
+    while (true)
+    {
+      std::uint64_t before = decoder.offset();
+      step_status status = decoder.step(budget);
+      within_budget = within_budget && decoder.offset() - before <= budget;
+      if (status == step_status::finished)
+      {
+        return out;
+      }
+      if (status == step_status::frame)
+      {
+        out.push_back({ true, { decoder.frame().begin(), decoder.frame().end() } });
+      }
+      else if (status == step_status::error)
+      {
+        out.push_back({ false, {}, decoder.error() });
+      }
+    }
+  }
+} // namespace
+
+UTEST(step, matches_decode_for_any_budget)
+{
+  auto encoded = mixed_stream(11);
+  std::list<std::byte> encoded_list(encoded.begin(), encoded.end());
+  auto expected = with_views(encoded);
+  ASSERT_TRUE(with_views(encoded_list) == expected);
+
+  for (std::size_t budget :
+       { std::size_t{ 1 }, std::size_t{ 3 }, std::size_t{ 64 }, std::size_t{ 1000 }, ~std::size_t{ 0 } })
+  {
+    bool within_budget = true;
+    ASSERT_TRUE(with_steps(encoded, budget, within_budget) == expected);
+    ASSERT_TRUE(with_steps(encoded_list, budget, within_budget) == expected);
+    ASSERT_TRUE(within_budget);
+  }
+}
+
+UTEST(step, resync_is_spread_over_steps)
+{
+  // An invalid frame followed by a long run of garbage before the next delimiter
+  std::vector<std::byte> input = { std::byte{ 0x05 }, std::byte{ 0x11 }, std::byte{ 0x00 } };
+  input.insert(input.begin() + 2, 300, std::byte{ 0x42 });
+  input.push_back(std::byte{ 0x02 });
+  input.push_back(std::byte{ 0x33 });
+  input.push_back(std::byte{ 0x00 });
+
+  auto decoder = decode_stepwise(input);
+  std::size_t pending = 0;
+  step_status status;
+  while ((status = decoder.step(16)) == step_status::pending)
+  {
+    ++pending;
+  }
+  ASSERT_TRUE(status == step_status::error);
+  ASSERT_EQ(decoder.error().kind, decode_error::invalid_cobs);
+  ASSERT_EQ(decoder.error().discarded, 303u);
+  ASSERT_GE(pending, 18u);
+
+  ASSERT_TRUE(decoder.step(16) == step_status::frame);
+  ASSERT_EQ(decoder.frame().size(), 1u);
+  ASSERT_TRUE(decoder.frame()[0] == std::byte{ 0x33 });
+  ASSERT_TRUE(decoder.step(16) == step_status::finished);
+}
+
+UTEST(step, resync_bytes_count_the_skipped_input)
+{
+  // A 20-byte frame over the 4-byte limit: the error is reported after 5 bytes, the other 17 are skipped
+  std::vector<std::byte> input(22, std::byte{ 0x42 });
+  input[0] = std::byte{ 0x15 };
+  input[21] = std::byte{ 0x00 };
+  input.push_back(std::byte{ 0x02 });
+  input.push_back(std::byte{ 0x33 });
+  input.push_back(std::byte{ 0x00 });
+
+  auto decoder = decode_stepwise<4>(input);
+  step_status status;
+  while ((status = decoder.step(4)) == step_status::pending)
+  {
+  }
+  ASSERT_TRUE(status == step_status::error);
+  ASSERT_EQ(decoder.error().kind, decode_error::oversized);
+  ASSERT_EQ(decoder.error().discarded, 5u);
+  ASSERT_EQ(decoder.resync_bytes(), 0u);
+
+  while ((status = decoder.step(4)) == step_status::pending)
+  {
+  }
+  ASSERT_TRUE(status == step_status::frame);
+  ASSERT_EQ(decoder.resync_bytes(), 17u);
+  ASSERT_EQ(decoder.offset(), 25u);
+}
@@ -0,0 +1,117 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <array>
+#include <cstdint>
+#include <list>
+#include <ranges>
+#include <span>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  struct telemetry
+  {
+    std::uint32_t id;
+    std::uint16_t flags;
+    std::uint16_t channel;
+    double value;
+  };
+
+  std::vector<std::byte> bytes_of(const telemetry &t)
+  {
+    auto s = std::as_bytes(std::span{ &t, 1 });
+    return { s.begin(), s.end() };
+  }
+} // namespace
+
+UTEST(decode_as, yields_structs)
+{
+  std::vector<telemetry> sent = { { 1, 0, 3, 0.5 }, { 0, 0xFF00, 0, -2.0 }, { 0x01020304, 7, 256, 1e9 } };
+  std::vector<std::vector<std::byte>> frames;
+  for (const auto &t : sent)
+  {
+    frames.push_back(bytes_of(t));
+  }
+  auto encoded = collect_bytes(frames | encode());
+  std::list<std::byte> encoded_list(encoded.begin(), encoded.end());
+
+  auto check = [&](auto &&input) {
+    std::size_t i = 0;
+    for (auto result : input | decode_as<telemetry>())
+    {
+      if (!result || sent.size() <= i || result->id != sent[i].id || result->flags != sent[i].flags ||
+          result->channel != sent[i].channel || result->value != sent[i].value)
+      {
+        return false;
+      }
+      ++i;
+    }
+    return i == sent.size();
+  };
+
+  ASSERT_TRUE(check(encoded));
+  ASSERT_TRUE(check(encoded_list));
+}
+
+UTEST(decode_as, size_mismatch_and_recovery)
+{
+  telemetry good{ 42, 1, 2, 3.0 };
+  auto good_bytes = bytes_of(good);
+  std::vector<std::byte> short_frame(good_bytes.begin(), good_bytes.end() - 1);
+  std::vector<std::byte> long_frame = good_bytes;
+  long_frame.push_back(std::byte{ 9 });
+
+  std::vector<std::vector<std::byte>> frames = { short_frame, long_frame, good_bytes };
+  auto encoded = collect_bytes(frames | encode());
+
+  std::vector<std::expected<telemetry, frame_error>> results;
+  for (auto result : encoded | decode_as<telemetry>())
+  {
+    results.push_back(result);
+  }
+
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_FALSE(results[0].has_value());
+  ASSERT_EQ(results[0].error().kind, decode_error::size_mismatch);
+  ASSERT_EQ(results[0].error().frame_index, 0u);
+  ASSERT_EQ(results[0].error().discarded, short_frame.size() + 2);
+  ASSERT_FALSE(results[1].has_value());
+  ASSERT_EQ(results[1].error().kind, decode_error::size_mismatch);
+  ASSERT_EQ(results[1].error().frame_index, 1u);
+  ASSERT_TRUE(results[2].has_value());
+  ASSERT_EQ(results[2]->id, good.id);
+  ASSERT_EQ(results[2]->value, good.value);
+}
+
+UTEST(decode_as, byte_array_and_custom_delimiter)
+{
+  std::array<std::byte, 32> frame{};
+  for (std::size_t i = 0; i < frame.size(); ++i)
+  {
+    frame[i] = std::byte{ static_cast<unsigned char>(i * 37) };
+  }
+  std::vector<std::array<std::byte, 32>> frames = { frame, frame };
+  auto encoded = collect_bytes(frames | encode(true, std::byte{ 0x7E }));
+
+  std::size_t count = 0;
+  for (auto result : encoded | decode_as<std::array<std::byte, 32>>(std::byte{ 0x7E }))
+  {
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(*result == frame);
+    ++count;
+  }
+  ASSERT_EQ(count, 2u);
+}
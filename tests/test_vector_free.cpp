@@ -58,7 +58,7 @@ UTEST(mamecobs, vector_free_single_byte_decode)
 
     if (!frame_result)
     {
-      ASSERT_EQ(frame_result.error(), decode_error::incomplete);
+      ASSERT_EQ(frame_result.error().kind, decode_error::incomplete);
     }
   }
 }
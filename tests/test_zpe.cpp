@@ -0,0 +1,303 @@
+#include "../src/mameCOBS.hpp"
+#include "utest.h"
+#include <list>
+#include <random>
+#include <ranges>
+#include <vector>
+
+using namespace mamecobs;
+
+namespace
+{
+  template <typename Range>
+  std::vector<std::byte> collect_bytes(Range &&range)
+  {
+    std::vector<std::byte> result;
+    for (auto b : range)
+    {
+      result.push_back(b);
+    }
+    return result;
+  }
+
+  template <typename Range>
+  std::vector<std::vector<std::byte>> collect_frames(Range &&range)
+  {
+    std::vector<std::vector<std::byte>> result;
+    for (auto frame_result : range)
+    {
+      if (frame_result.has_value())
+      {
+        result.emplace_back(frame_result->begin(), frame_result->end());
+      }
+    }
+    return result;
+  }
+} // namespace
+
+UTEST(zpe, encode_zero_pair)
+{
+  // [0x11, 0x22, 0x00, 0x00, 0x33] -> [0xE3, 0x11, 0x22, 0x02, 0x33]
+  std::vector<std::byte> input = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+  auto result = collect_bytes(input | encode_zpe(false));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0xE3 }, std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x02 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(zpe, encode_single_zero_matches_cobs)
+{
+  // [0x11, 0x00, 0x22] -> [0x02, 0x11, 0x02, 0x22]
+  std::vector<std::byte> input = { std::byte{ 0x11 }, std::byte{ 0x00 }, std::byte{ 0x22 } };
+  auto result = collect_bytes(input | encode_zpe(false));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x02 }, std::byte{ 0x11 }, std::byte{ 0x02 }, std::byte{ 0x22 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(zpe, encode_zero_run)
+{
+  // Ten zeros plus the implicit trailing zero -> five pair codes and one single code
+  std::vector<std::byte> input(10, std::byte{ 0x00 });
+  auto result = collect_bytes(input | encode_zpe(true));
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0xE1 }, std::byte{ 0xE1 }, std::byte{ 0xE1 }, std::byte{ 0xE1 },
+    std::byte{ 0xE1 }, std::byte{ 0x01 }, std::byte{ 0x00 }
+  };
+
+  ASSERT_EQ(result.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(result[i], expected[i]);
+  }
+}
+
+UTEST(zpe, decode_zero_pair)
+{
+  std::vector<std::byte> input = { std::byte{ 0xE3 }, std::byte{ 0x11 }, std::byte{ 0x22 },
+                                   std::byte{ 0x02 }, std::byte{ 0x33 }, std::byte{ 0x00 } };
+  auto frames = collect_frames(input | decode_zpe());
+
+  std::vector<std::byte> expected = {
+    std::byte{ 0x11 }, std::byte{ 0x22 }, std::byte{ 0x00 }, std::byte{ 0x00 }, std::byte{ 0x33 }
+  };
+
+  ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+  ASSERT_EQ(frames[0].size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(frames[0][i], expected[i]);
+  }
+}
+
+UTEST(zpe, decode_pair_at_end_of_frame)
+{
+  // A pair code right before the delimiter yields one zero (the other is implicit)
+  std::vector<std::byte> input = { std::byte{ 0xE2 }, std::byte{ 0x42 }, std::byte{ 0x00 } };
+  auto frames = collect_frames(input | decode_zpe());
+
+  ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+  ASSERT_EQ(frames[0].size(), static_cast<size_t>(2));
+  ASSERT_EQ(frames[0][0], std::byte{ 0x42 });
+  ASSERT_EQ(frames[0][1], std::byte{ 0x00 });
+}
+
+UTEST(zpe, decode_errors)
+{
+  // Delimiter inside a block
+  std::vector<std::byte> truncated = { std::byte{ 0xE4 }, std::byte{ 0x11 }, std::byte{ 0x00 } };
+  bool found_error = false;
+  for (auto frame_result : truncated | decode_zpe())
+  {
+    if (!frame_result)
+    {
+      found_error = true;
+      ASSERT_EQ(frame_result.error().kind, decode_error::invalid_cobs);
+    }
+  }
+  ASSERT_TRUE(found_error);
+
+  // Zero pair exceeding MaxFrameSize
+  std::vector<std::byte> oversized = { std::byte{ 0xE3 }, std::byte{ 0x11 }, std::byte{ 0x22 },
+                                       std::byte{ 0x02 }, std::byte{ 0x33 }, std::byte{ 0x00 } };
+  found_error = false;
+  for (auto frame_result : oversized | decode_zpe<3>())
+  {
+    if (!frame_result)
+    {
+      found_error = true;
+      ASSERT_EQ(frame_result.error().kind, decode_error::oversized);
+    }
+  }
+  ASSERT_TRUE(found_error);
+}
+
+UTEST(zpe, errors_report_offset_frame_index_and_discarded)
+{
+  // A good frame, a block cut short by the delimiter at offset 5, another good frame
+  std::vector<std::byte> input = { std::byte{ 0x02 }, std::byte{ 0x11 }, std::byte{ 0x00 },
+                                   std::byte{ 0xE4 }, std::byte{ 0x11 }, std::byte{ 0x00 },
+                                   std::byte{ 0x02 }, std::byte{ 0x22 }, std::byte{ 0x00 } };
+  std::vector<frame_error> errors;
+  std::size_t good = 0;
+  for (auto frame_result : input | decode_zpe())
+  {
+    if (frame_result)
+    {
+      ++good;
+    }
+    else
+    {
+      errors.push_back(frame_result.error());
+    }
+  }
+
+  ASSERT_EQ(good, static_cast<size_t>(2));
+  ASSERT_EQ(errors.size(), static_cast<size_t>(1));
+  ASSERT_EQ(errors[0].kind, decode_error::invalid_cobs);
+  ASSERT_EQ(errors[0].offset, static_cast<std::uint64_t>(5));
+  ASSERT_EQ(errors[0].frame_index, static_cast<std::uint64_t>(1));
+  ASSERT_EQ(errors[0].discarded, static_cast<std::uint64_t>(3));
+}
+
+UTEST(zpe, resync_bytes_count_the_rest_of_a_failed_frame)
+{
+  // The zero pair overflows a 3-byte frame at offset 3; the other 3 bytes of the frame are skipped
+  std::vector<std::byte> input = { std::byte{ 0xE3 }, std::byte{ 0x11 }, std::byte{ 0x22 },
+                                   std::byte{ 0x02 }, std::byte{ 0x33 }, std::byte{ 0x00 },
+                                   std::byte{ 0x02 }, std::byte{ 0x44 }, std::byte{ 0x00 } };
+  auto decoded = input | decode_zpe<3>();
+  auto it = decoded.begin();
+  ASSERT_FALSE((*it).has_value());
+  ASSERT_EQ((*it).error().discarded, static_cast<std::uint64_t>(3));
+  ASSERT_EQ(it.resync_bytes(), static_cast<std::uint64_t>(0));
+
+  ++it;
+  ASSERT_TRUE((*it).has_value());
+  ASSERT_EQ(it.resync_bytes(), static_cast<std::uint64_t>(3));
+}
+
+UTEST(zpe, sparse_payload_is_smaller)
+{
+  // Sensor-style frame: mostly zero runs
+  std::vector<std::byte> original(200, std::byte{ 0x00 });
+  for (size_t i = 0; i < original.size(); i += 17)
+  {
+    original[i] = std::byte{ 0x5A };
+  }
+
+  auto plain = collect_bytes(original | encode(true));
+  auto zpe = collect_bytes(original | encode_zpe(true));
+  ASSERT_LT(zpe.size(), plain.size());
+
+  auto frames = collect_frames(zpe | decode_zpe());
+  ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+  ASSERT_EQ(frames[0].size(), original.size());
+  for (size_t i = 0; i < original.size(); ++i)
+  {
+    ASSERT_EQ(frames[0][i], original[i]);
+  }
+}
+
+UTEST(zpe, roundtrip_random_frames)
+{
+  // Contiguous (vector) and input-only (list) frames must encode identically
+  std::mt19937 gen(27);
+  std::uniform_int_distribution<> dis(0, 255);
+  std::uniform_int_distribution<> len(0, 700);
+
+  for (int n = 0; n < 200; ++n)
+  {
+    std::vector<std::byte> original(static_cast<size_t>(len(gen)));
+    int zero_threshold = n % 4 * 60;
+    for (auto &b : original)
+    {
+      int v = dis(gen);
+      b = std::byte{ static_cast<unsigned char>(v < zero_threshold ? 0 : v) };
+    }
+    std::list<std::byte> listed(original.begin(), original.end());
+
+    auto encoded = collect_bytes(original | encode_zpe(true));
+    auto encoded_list = collect_bytes(listed | encode_zpe(true));
+    ASSERT_EQ(encoded.size(), encoded_list.size());
+    for (size_t i = 0; i < encoded.size(); ++i)
+    {
+      ASSERT_EQ(encoded[i], encoded_list[i]);
+    }
+
+    std::list<std::byte> encoded_stream(encoded.begin(), encoded.end());
+    auto frames = collect_frames(encoded | decode_zpe());
+    auto frames_list = collect_frames(encoded_stream | decode_zpe());
+    ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+    ASSERT_EQ(frames_list.size(), static_cast<size_t>(1));
+    ASSERT_EQ(frames[0].size(), original.size());
+    ASSERT_EQ(frames_list[0].size(), original.size());
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+      ASSERT_EQ(frames[0][i], original[i]);
+      ASSERT_EQ(frames_list[0][i], original[i]);
+    }
+  }
+}
+
+UTEST(zpe, roundtrip_run_boundaries)
+{
+  // Runs around the 0xE0 (223 byte) and pair (30 byte) limits, followed by zero pairs
+  for (size_t run : { 29, 30, 31, 221, 222, 223, 224, 446 })
+  {
+    for (size_t zeros : { 0, 1, 2, 3 })
+    {
+      std::vector<std::byte> original(run, std::byte{ 0x33 });
+      original.insert(original.end(), zeros, std::byte{ 0x00 });
+      original.push_back(std::byte{ 0x44 });
+      original.insert(original.end(), run, std::byte{ 0x55 });
+
+      auto encoded = collect_bytes(original | encode_zpe(true));
+      auto frames = collect_frames(encoded | decode_zpe());
+
+      ASSERT_EQ(frames.size(), static_cast<size_t>(1));
+      ASSERT_EQ(frames[0].size(), original.size());
+      for (size_t i = 0; i < original.size(); ++i)
+      {
+        ASSERT_EQ(frames[0][i], original[i]);
+      }
+    }
+  }
+}
+
+UTEST(zpe, multiple_frames)
+{
+  std::vector<std::vector<std::byte>> frames = { { std::byte{ 0x00 }, std::byte{ 0x00 } },
+                                                 {},
+                                                 { std::byte{ 0x11 }, std::byte{ 0x00 } } };
+
+  auto encoded = collect_bytes(frames | encode_zpe(true));
+  auto decoded = collect_frames(encoded | decode_zpe());
+
+  ASSERT_EQ(decoded.size(), frames.size());
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    ASSERT_EQ(decoded[i].size(), frames[i].size());
+    for (size_t j = 0; j < frames[i].size(); ++j)
+    {
+      ASSERT_EQ(decoded[i][j], frames[i][j]);
+    }
+  }
+}